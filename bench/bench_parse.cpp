@@ -0,0 +1,158 @@
+// Allocation and latency benchmark for parseEEPROM.
+//
+// Replaces the global operator new to count every heap allocation made while parsing, on the
+// calling thread and on pool threads alike. Each image is parsed N times into a scratch folder
+// with one parse_workspace, after a warm-up pass that fills the caches kept between parses.
+// Then it is parsed N times more with parallel section decoding turned off, and the time per
+// parse of both runs is reported side by side.
+//
+//  CapeEEPROMBench [-runs=N] [images or folders...]
+//
+// Without arguments the fuzz seed corpus is used.
+
+#include "cape_utils.h"
+#include "parse_workspace.h"
+#include "section_handlers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "spdlog/sinks/null_sink.h"
+
+namespace
+{
+    std::atomic<std::size_t> allocations{ 0 };
+    std::atomic<std::size_t> allocated_bytes{ 0 };
+
+    void* counted_alloc(std::size_t size)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+        void* p = std::malloc(size == 0 ? 1 : size);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+}
+
+// the nothrow forms forward to these
+void* operator new(std::size_t size) { return counted_alloc(size); }
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+int main(int argc, char* argv[])
+{
+    std::size_t runs{ 100 };
+    std::vector<std::filesystem::path> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string const arg = argv[i];
+        if (arg.starts_with("-runs=")) {
+            runs = std::max<std::size_t>(1, std::strtoull(arg.c_str() + 6, nullptr, 10));
+        }
+        else {
+            paths.emplace_back(arg);
+        }
+    }
+    if (paths.empty()) {
+        paths.emplace_back(CAPE_BENCH_CORPUS);
+    }
+
+    std::vector<std::string> images;
+    for (auto const& path : paths) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(path, ec)) {
+            images.push_back(path.string());
+            continue;
+        }
+        for (auto const& entry : std::filesystem::directory_iterator(path, ec)) {
+            if (entry.is_regular_file(ec)) {
+                images.push_back(entry.path().string());
+            }
+        }
+    }
+    std::sort(images.begin(), images.end());
+    if (images.empty()) {
+        std::fprintf(stderr, "usage: %s [-runs=N] [images or folders...]\n", argv[0]);
+        return 1;
+    }
+
+    // parseEEPROM logs through this name, keep it quiet
+    spdlog::create<spdlog::sinks::null_sink_mt>("capeeepromviewer");
+
+    std::filesystem::path const scratch = std::filesystem::temp_directory_path() /
+        ("cape_bench_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    std::string const extractDir = (scratch / "image").string() + "/";
+    parse_workspace workspace;
+
+    for (auto const& image : images) {
+        cape_utils::parseEEPROM(image, extractDir, workspace);
+    }
+
+    section_registry& registry = section_registry::defaults();
+    auto const time_runs = [&](std::string const& image, bool parallel) {
+        registry.set_parallel(parallel);
+        auto const start = std::chrono::steady_clock::now();
+        for (std::size_t run = 0; run < runs; ++run) {
+            cape_utils::parseEEPROM(image, extractDir, workspace);
+        }
+        registry.set_parallel(true);
+        return std::chrono::steady_clock::now() - start;
+    };
+    auto const ms_per_parse = [&](std::chrono::steady_clock::duration elapsed) {
+        return std::chrono::duration<double, std::milli>(elapsed).count() / runs;
+    };
+
+    std::printf("%-28s %12s %12s %10s %12s %12s\n", "image", "allocs/parse", "bytes/parse", "spills", "ms parallel", "ms serial");
+    std::size_t totalAllocations{ 0 };
+    std::size_t totalBytes{ 0 };
+    std::size_t totalSpills{ 0 };
+    std::chrono::steady_clock::duration parallelTime{};
+    std::chrono::steady_clock::duration serialTime{};
+    for (auto const& image : images) {
+        std::size_t spills{ 0 };
+        std::size_t const startAllocations = allocations.load();
+        std::size_t const startBytes = allocated_bytes.load();
+        for (std::size_t run = 0; run < runs; ++run) {
+            cape_utils::parseEEPROM(image, extractDir, workspace);
+            spills += workspace.spills();
+        }
+        std::size_t const imageAllocations = allocations.load() - startAllocations;
+        std::size_t const imageBytes = allocated_bytes.load() - startBytes;
+
+        // timed apart from the counted runs, and alternating so drift hits both modes alike
+        auto const parallel = time_runs(image, true);
+        auto const serial = time_runs(image, false);
+        parallelTime += parallel;
+        serialTime += serial;
+
+        std::printf("%-28s %12.1f %12.0f %10.2f %12.3f %12.3f\n", std::filesystem::path(image).filename().string().c_str(),
+            double(imageAllocations) / runs, double(imageBytes) / runs, double(spills) / runs, ms_per_parse(parallel), ms_per_parse(serial));
+        totalAllocations += imageAllocations;
+        totalBytes += imageBytes;
+        totalSpills += spills;
+    }
+
+    std::size_t const parses = runs * images.size();
+    double const parallelSeconds = std::chrono::duration<double>(parallelTime).count();
+    double const serialSeconds = std::chrono::duration<double>(serialTime).count();
+    std::printf("%zu parses, %.1f allocations and %.0f bytes per parse, %.2f arena spills per parse\n",
+        parses, double(totalAllocations) / parses, double(totalBytes) / parses, double(totalSpills) / parses);
+    std::printf("parallel decode %.2f s, serial decode %.2f s, %.2fx\n",
+        parallelSeconds, serialSeconds, parallelSeconds > 0 ? serialSeconds / parallelSeconds : 0.0);
+
+    std::error_code ec;
+    std::filesystem::remove_all(scratch, ec);
+    return 0;
+}
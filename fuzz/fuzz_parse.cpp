@@ -0,0 +1,254 @@
+// Fuzz target for parseEEPROM.
+//
+// Built with CAPE_FUZZ_LIBFUZZER it is a plain libFuzzer target. Otherwise it carries its own
+// driver: it runs every seed in the given corpus folders, then keeps mutating them and reports
+// execs/sec until the run or time limit is reached.
+//
+//  CapeEEPROMFuzz [-runs=N] [-seconds=N] [-seed=N] fuzz/corpus
+//
+// Each input is written to a scratch folder and parsed with its extraction folder nested deep inside it.
+// Besides crashes, any file that appears next to the extraction folder or one of its parents means a
+// section escaped it.
+
+#include "cape_utils.h"
+#include "fpp_layout.h"
+#include "parse_workspace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "spdlog/sinks/null_sink.h"
+
+namespace
+{
+    // a path field climbs at most one level per "../", nest the extraction deeper than that
+    constexpr std::size_t depth{ fpp_layout::section_path.length / 3 + 1 };
+
+    struct scratch
+    {
+        scratch()
+            : dir(std::filesystem::temp_directory_path() /
+                ("cape_fuzz_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())))
+            , image(dir / "image.bin")
+        {
+            levels.push_back(dir);
+            for (std::size_t i = 0; i < depth; ++i) {
+                levels.push_back(levels.back() / "d");
+            }
+            extractDir = (levels.back() / "image").string() + "/";
+            std::filesystem::create_directories(levels.back());
+            // parseEEPROM logs through this name, keep it quiet
+            spdlog::create<spdlog::sinks::null_sink_mt>("capeeepromviewer");
+        }
+
+        std::filesystem::path dir;
+        std::filesystem::path image;
+        std::vector<std::filesystem::path> levels;   // dir down to the parent of the extraction folder
+        std::string extractDir;
+        parse_workspace workspace;
+    };
+
+    scratch& state()
+    {
+        static scratch s;
+        return s;
+    }
+
+    void run_one(const uint8_t* data, std::size_t size)
+    {
+        scratch& s = state();
+        std::error_code ec;
+        std::filesystem::remove_all(s.extractDir, ec);
+        {
+            std::ofstream image(s.image, std::ios::binary | std::ios::trunc);
+            image.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        }
+
+        cape_utils::parseEEPROM(s.image.string(), s.extractDir, s.workspace);
+
+        // each level may only hold the next one down, plus the image at the top
+        for (std::size_t level = 0; level < s.levels.size(); ++level) {
+            std::filesystem::path const next = level + 1 < s.levels.size() ? s.levels[level + 1].filename() : "image";
+            for (auto const& entry : std::filesystem::directory_iterator(s.levels[level], ec)) {
+                auto const name = entry.path().filename();
+                if (name != next && (level != 0 || name != "image.bin")) {
+                    std::fprintf(stderr, "section escaped the extraction folder: %s\n", entry.path().string().c_str());
+                    std::fprintf(stderr, "input kept in %s\n", s.image.string().c_str());
+                    std::abort();
+                }
+            }
+        }
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size)
+{
+    run_one(data, size);
+    return 0;
+}
+
+#ifndef CAPE_FUZZ_LIBFUZZER
+
+namespace
+{
+    using image = std::vector<uint8_t>;
+
+    std::vector<image> load_corpus(std::vector<std::string> const& paths)
+    {
+        std::vector<std::filesystem::path> files;
+        for (auto const& path : paths) {
+            std::error_code ec;
+            if (!std::filesystem::is_directory(path, ec)) {
+                files.emplace_back(path);
+                continue;
+            }
+            for (auto const& entry : std::filesystem::directory_iterator(path, ec)) {
+                if (entry.is_regular_file(ec)) {
+                    files.push_back(entry.path());
+                }
+            }
+        }
+        std::sort(files.begin(), files.end());
+
+        std::vector<image> corpus;
+        for (auto const& file : files) {
+            std::ifstream in(file, std::ios::binary);
+            corpus.emplace_back(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        return corpus;
+    }
+
+    // bytes that steer the parser: digits for the length and flag fields, padding and path separators
+    constexpr uint8_t interesting[] = { '0', '1', '2', '3', '9', ' ', '\0', '/', '.', '\\', 0xff };
+
+    void mutate(image& data, std::vector<image> const& corpus, std::mt19937& rng)
+    {
+        auto pick = [&](std::size_t limit) { return std::uniform_int_distribution<std::size_t>(0, limit - 1)(rng); };
+        std::size_t const rounds = 1 + pick(4);
+        for (std::size_t round = 0; round < rounds; ++round) {
+            if (data.empty()) {
+                data.push_back(interesting[pick(std::size(interesting))]);
+                continue;
+            }
+            switch (pick(6)) {
+            case 0:
+                data[pick(data.size())] ^= static_cast<uint8_t>(1u << pick(8));
+                break;
+            case 1:
+                data[pick(data.size())] = interesting[pick(std::size(interesting))];
+                break;
+            case 2: {
+                // a new section length, these decide where the next section starts
+                std::string const number = std::to_string(pick(fpp_layout::max_image_size * 2));
+                std::size_t const at = pick(data.size());
+                for (std::size_t i = 0; i < 6 && at + i < data.size(); ++i) {
+                    data[at + i] = i < 6 - number.size() ? '0' : static_cast<uint8_t>(number[i - (6 - number.size())]);
+                }
+                break;
+            }
+            case 3:
+                data.resize(pick(data.size()));
+                break;
+            case 4: {
+                std::size_t const from = pick(data.size());
+                std::size_t const len = 1 + pick(std::min<std::size_t>(data.size() - from, 128));
+                image const chunk(data.begin() + from, data.begin() + from + len);
+                data.insert(data.begin() + pick(data.size()), chunk.begin(), chunk.end());
+                break;
+            }
+            default: {
+                // splice in the tail of another seed
+                image const& other = corpus[pick(corpus.size())];
+                if (!other.empty()) {
+                    std::size_t const at = pick(data.size());
+                    std::size_t const from = pick(other.size());
+                    data.resize(at);
+                    data.insert(data.end(), other.begin() + from, other.end());
+                }
+            }
+            }
+        }
+        if (data.size() > fpp_layout::max_image_size * 2) {
+            data.resize(fpp_layout::max_image_size * 2);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // 10000 runs unless a time limit is given, then it runs until the time is up
+    std::size_t runs{ 0 };
+    double seconds{ 0 };
+    unsigned seed{ 1 };
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string const arg = argv[i];
+        if (arg.starts_with("-runs=")) {
+            runs = std::strtoull(arg.c_str() + 6, nullptr, 10);
+        }
+        else if (arg.starts_with("-seconds=")) {
+            seconds = std::strtod(arg.c_str() + 9, nullptr);
+        }
+        else if (arg.starts_with("-seed=")) {
+            seed = static_cast<unsigned>(std::strtoul(arg.c_str() + 6, nullptr, 10));
+        }
+        else {
+            paths.push_back(arg);
+        }
+    }
+
+    if (runs == 0 && seconds <= 0) {
+        runs = 10000;
+    }
+
+    std::vector<image> const corpus = load_corpus(paths);
+    if (corpus.empty()) {
+        std::fprintf(stderr, "usage: %s [-runs=N] [-seconds=N] [-seed=N] <corpus dir or files>...\n", argv[0]);
+        return 1;
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    auto elapsed = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+    auto report = [&](char const* what, std::size_t execs) {
+        double const secs = elapsed();
+        std::printf("%s %zu execs in %.1f s, %.0f exec/s\n", what, execs, secs, secs > 0 ? execs / secs : 0.0);
+        std::fflush(stdout);
+    };
+
+    for (auto const& data : corpus) {
+        run_one(data.data(), data.size());
+    }
+    report("seeds:", corpus.size());
+
+    std::mt19937 rng(seed);
+    std::size_t execs{ 0 };
+    double nextReport{ 1.0 };
+    image data;
+    while ((runs == 0 || execs < runs) && (seconds <= 0 || elapsed() < seconds)) {
+        data = corpus[std::uniform_int_distribution<std::size_t>(0, corpus.size() - 1)(rng)];
+        mutate(data, corpus, rng);
+        run_one(data.data(), data.size());
+        ++execs;
+        if (elapsed() >= nextReport) {
+            report("fuzz:", execs);
+            nextReport += 1.0;
+        }
+    }
+    report("done:", execs);
+
+    std::error_code ec;
+    std::filesystem::remove_all(state().dir, ec);
+    return 0;
+}
+
+#endif // CAPE_FUZZ_LIBFUZZER
@@ -0,0 +1,216 @@
+#include "cape_audit.h"
+#include "cape_config.h"
+#include "cape_utils.h"
+#include "parse_workspace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "spdlog/spdlog.h"
+
+namespace
+{
+    std::string read_file(std::filesystem::path const& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // a fresh folder below the system temp folder, the inventory tree is never written to
+    std::filesystem::path make_workspace()
+    {
+        auto const stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+        std::filesystem::path const dir = std::filesystem::temp_directory_path() / ("cape_audit_" + std::to_string(stamp));
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+}
+
+namespace cape_audit
+{
+    csv_table::~csv_table()
+    {
+        close();
+    }
+
+    bool csv_table::open(std::string const& path, std::vector<std::string> const& columns)
+    {
+        m_file = fopen(path.c_str(), "wb");
+        if (m_file == nullptr) {
+            return false;
+        }
+        m_columns = columns.size();
+        add_row(columns);
+        return true;
+    }
+
+    void csv_table::add_row(std::vector<std::string> const& values)
+    {
+        for (std::size_t i = 0; i < m_columns; ++i) {
+            if (i != 0) {
+                m_buffer += ',';
+            }
+            append_field(i < values.size() ? values[i] : std::string());
+        }
+        m_buffer += '\n';
+        if (++m_rows >= batch_rows) {
+            flush();
+        }
+    }
+
+    bool csv_table::flush()
+    {
+        if (m_file != nullptr && !m_buffer.empty()) {
+            m_ok = fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) == m_buffer.size() && m_ok;
+        }
+        m_buffer.clear();
+        m_rows = 0;
+        return m_ok;
+    }
+
+    bool csv_table::close()
+    {
+        if (m_file == nullptr) {
+            return m_ok;
+        }
+        flush();
+        m_ok = fclose(m_file) == 0 && m_ok;
+        m_file = nullptr;
+        return m_ok;
+    }
+
+    void csv_table::append_field(std::string const& value)
+    {
+        if (value.find_first_of(",\"\r\n") == std::string::npos) {
+            m_buffer += value;
+            return;
+        }
+        m_buffer += '"';
+        for (char const c : value) {
+            if (c == '"') {
+                m_buffer += '"';
+            }
+            m_buffer += c;
+        }
+        m_buffer += '"';
+    }
+
+    std::vector<std::string> collect_eeproms(std::vector<std::string> const& paths)
+    {
+        std::vector<std::string> eeproms;
+        for (auto const& path : paths) {
+            std::error_code ec;
+            if (!std::filesystem::is_directory(path, ec)) {
+                eeproms.push_back(path);
+                continue;
+            }
+            std::vector<std::string> found;
+            // folders we may not read are skipped, a single one must not end the walk
+            for (auto it = std::filesystem::recursive_directory_iterator(path, std::filesystem::directory_options::skip_permission_denied, ec);
+                 !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+                std::error_code typeEc;
+                auto const ext = it->path().extension();
+                if (it->is_regular_file(typeEc) && (ext == ".bin" || ext == ".eeprom")) {
+                    found.push_back(it->path().string());
+                }
+            }
+            std::sort(found.begin(), found.end());
+            eeproms.insert(eeproms.end(), found.begin(), found.end());
+        }
+        return eeproms;
+    }
+
+    bool export_audit(std::vector<std::string> const& eeproms, std::string const& outdir, std::string& error)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(outdir, ec);
+        std::filesystem::path const dir(outdir);
+
+        csv_table capes;
+        csv_table sections;
+        csv_table pins;
+        if (!capes.open((dir / "capes.csv").string(), { "eeprom", "name", "version", "serial", "folder", "error" }) ||
+            !sections.open((dir / "sections.csv").string(), { "eeprom", "index", "flag", "offset", "size", "path" }) ||
+            !pins.open((dir / "pins.csv").string(), { "eeprom", "source", "pin", "mode", "desc", "edge", "command", "arg", "type", "device", "port" })) {
+            error = "unable to create audit files in " + outdir;
+            return false;
+        }
+
+        std::filesystem::path workdir;
+        try
+        {
+            workdir = make_workspace();
+        }
+        catch (std::exception const& ex)
+        {
+            error = std::string("unable to create a temporary folder: ") + ex.what();
+            return false;
+        }
+
+        auto logger = spdlog::get("capeeepromviewer");
+        parse_workspace workspace;
+        std::size_t count{ 0 };
+        for (auto const& eeprom : eeproms) {
+            // every image gets its own folder, images with the same name must not share one
+            std::filesystem::path const extractDir = workdir / std::to_string(count++);
+            cape_info const info = cape_utils::parseEEPROM(eeprom, extractDir.string() + "/", workspace);
+
+            // the folder column is relative to the extraction, the extraction itself is temporary
+            std::string folderColumn;
+            if (!info.folder.empty()) {
+                folderColumn = std::filesystem::path(info.folder).lexically_relative(extractDir).generic_string();
+            }
+            capes.add_row({ eeprom, info.name, info.version, info.serialNumber, folderColumn, info.error });
+
+            std::size_t index{ 0 };
+            for (auto const& entry : workspace.sections()) {
+                sections.add_row({ eeprom, std::to_string(index++), std::to_string(entry.flag),
+                    std::to_string(entry.offset), std::to_string(entry.size), std::string(entry.name) });
+            }
+
+            if (!info.folder.empty()) {
+                std::filesystem::path const folder(info.folder);
+
+                auto add_gpio = [&](std::string const& source, std::vector<cape_config::gpio_row> const& rows) {
+                    for (auto const& row : rows) {
+                        pins.add_row({ eeprom, source, row.pin, row.mode, row.desc, row.edge, row.command, row.arg, row.type, "", "" });
+                    }
+                };
+                add_gpio("gpio.json", cape_config::read_gpio(read_file(folder / "defaults" / "config" / "gpio.json")));
+                add_gpio("cape-inputs.json", cape_config::read_inputs(read_file(folder / "cape-inputs.json")));
+
+                for (auto const& row : cape_config::read_other(read_file(folder / "defaults" / "config" / "co-other.json"))) {
+                    pins.add_row({ eeprom, "co-other.json", "", "", "", "", "", "", row.type, row.device, "" });
+                }
+
+                std::vector<std::filesystem::path> stringFiles;
+                for (auto const& entry : std::filesystem::directory_iterator(folder / "strings", ec)) {
+                    if (entry.path().extension() == ".json") {
+                        stringFiles.push_back(entry.path());
+                    }
+                }
+                std::sort(stringFiles.begin(), stringFiles.end());
+                for (auto const& file : stringFiles) {
+                    std::string const source = "strings/" + file.filename().string();
+                    for (auto const& row : cape_config::read_string_ports(read_file(file))) {
+                        pins.add_row({ eeprom, source, row.pin, "", "", "", "", "", "", "", row.serial ? "serial" : "output" });
+                    }
+                }
+            }
+            std::filesystem::remove_all(extractDir, ec);
+        }
+        std::filesystem::remove_all(workdir, ec);
+
+        bool const ok = capes.close() & sections.close() & pins.close();
+        if (!ok) {
+            error = "failed writing audit files in " + outdir;
+        }
+        if (logger) {
+            logger->info("Audited {} eeproms into {}", eeproms.size(), outdir);
+        }
+        return ok;
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef CAPE_AUDIT_H
+#define CAPE_AUDIT_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Bulk inventory export over many EEPROM images.
+// Writes three tables next to each other: capes.csv, sections.csv and pins.csv,
+// all keyed by the eeprom path so they can be joined later.
+namespace cape_audit
+{
+	// Streams rows to a CSV file, buffering at most batch_rows rows in memory.
+	class csv_table
+	{
+	public:
+		static constexpr std::size_t batch_rows{ 1024 };
+
+		csv_table() = default;
+		~csv_table();
+
+		csv_table(csv_table const&) = delete;
+		csv_table& operator=(csv_table const&) = delete;
+
+		bool open(std::string const& path, std::vector<std::string> const& columns);
+		void add_row(std::vector<std::string> const& values);
+		bool flush();
+		bool close();
+
+	private:
+		void append_field(std::string const& value);
+
+		FILE* m_file{ nullptr };
+		std::size_t m_columns{ 0 };
+		std::size_t m_rows{ 0 };
+		std::string m_buffer;
+		bool m_ok{ true };
+	};
+
+	// expands directories to the .bin and .eeprom files below them
+	std::vector<std::string> collect_eeproms(std::vector<std::string> const& paths);
+
+	bool export_audit(std::vector<std::string> const& eeproms, std::string const& outdir, std::string& error);
+};
+
+#endif // CAPE_AUDIT_H
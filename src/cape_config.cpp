@@ -0,0 +1,308 @@
+#include "cape_config.h"
+#include "json_cursor.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+    struct edge_action
+    {
+        bool present{ false };
+        std::string command;
+        std::string arg;
+    };
+
+    // { "command": "...", "args": [ "..." ] }
+    edge_action read_edge(json_cursor& json)
+    {
+        edge_action action;
+        action.present = true;
+        if (!json.begin_object()) {
+            return action;
+        }
+        std::string_view key;
+        while (json.next_member(key)) {
+            if (key == "command") {
+                action.command = json.string().value_or("");
+            }
+            else if (key == "args" && json.begin_array()) {
+                bool first{ true };
+                while (json.next_element()) {
+                    if (first) {
+                        action.arg = json.string().value_or("");
+                        first = false;
+                    }
+                    else {
+                        json.skip();
+                    }
+                }
+            }
+            else if (key != "args") {
+                json.skip();
+            }
+        }
+        return action;
+    }
+
+    // { "url": "..." }
+    std::string read_url(json_cursor& json)
+    {
+        std::string url;
+        if (!json.begin_object()) {
+            return url;
+        }
+        std::string_view key;
+        while (json.next_member(key)) {
+            if (key == "url") {
+                url = json.string().value_or("");
+            }
+            else {
+                json.skip();
+            }
+        }
+        return url;
+    }
+
+    std::optional<std::string> read_file(std::filesystem::path const& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return std::nullopt;
+        }
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // a document that does not parse shows nothing, the same as QJsonDocument
+    template <typename Rows>
+    Rows checked(json_cursor& json, Rows rows)
+    {
+        return json.finished() ? std::move(rows) : Rows();
+    }
+
+    // calls read_row for each element of the array stored under key in the top level object
+    template <typename Row, typename ReadRow>
+    std::vector<Row> read_member_array(std::string_view text, std::string_view member, ReadRow read_row)
+    {
+        std::vector<Row> rows;
+        json_cursor json(text);
+        if (!json.begin_object()) {
+            return rows;
+        }
+        std::string_view key;
+        while (json.next_member(key)) {
+            if (key != member || !json.begin_array()) {
+                if (key != member) {
+                    json.skip();
+                }
+                continue;
+            }
+            while (json.next_element()) {
+                rows.push_back(read_row(json));
+            }
+        }
+        return checked(json, std::move(rows));
+    }
+
+    template <typename Row, typename Assign>
+    Row read_fields(json_cursor& json, Assign assign)
+    {
+        Row row;
+        if (!json.begin_object()) {
+            return row;
+        }
+        std::string_view key;
+        while (json.next_member(key)) {
+            if (!assign(row, key, json)) {
+                json.skip();
+            }
+        }
+        return row;
+    }
+}
+
+namespace cape_config
+{
+    std::vector<gpio_row> read_gpio(std::string_view text)
+    {
+        std::vector<gpio_row> rows;
+        json_cursor json(text);
+        if (!json.begin_array()) {
+            return rows;
+        }
+        while (json.next_element()) {
+            edge_action rising;
+            edge_action falling;
+            gpio_row row = read_fields<gpio_row>(json, [&](gpio_row& r, std::string_view key, json_cursor& j) {
+                if (key == "pin") { r.pin = j.string().value_or(""); return true; }
+                if (key == "mode") { r.mode = j.string().value_or(""); return true; }
+                if (key == "desc") { r.desc = j.string().value_or(""); return true; }
+                if (key == "rising") { rising = read_edge(j); return true; }
+                if (key == "falling") { falling = read_edge(j); return true; }
+                return false;
+            });
+            // rising wins when both are configured
+            edge_action const& edge = rising.present ? rising : falling;
+            if (edge.present) {
+                row.edge = rising.present ? "rising" : "falling";
+                row.command = edge.command;
+                row.arg = edge.arg;
+            }
+            rows.push_back(std::move(row));
+        }
+        return checked(json, std::move(rows));
+    }
+
+    std::vector<gpio_row> read_inputs(std::string_view text)
+    {
+        return read_member_array<gpio_row>(text, "inputs", [](json_cursor& json) {
+            return read_fields<gpio_row>(json, [](gpio_row& r, std::string_view key, json_cursor& j) {
+                if (key == "pin") { r.pin = j.string().value_or(""); return true; }
+                if (key == "mode") { r.mode = j.string().value_or(""); return true; }
+                if (key == "edge") { r.edge = j.string().value_or(""); return true; }
+                if (key == "type") { r.type = j.string().value_or(""); return true; }
+                return false;
+            });
+        });
+    }
+
+    std::vector<other_row> read_other(std::string_view text)
+    {
+        return read_member_array<other_row>(text, "channelOutputs", [](json_cursor& json) {
+            return read_fields<other_row>(json, [](other_row& r, std::string_view key, json_cursor& j) {
+                if (key == "type") { r.type = j.string().value_or(""); return true; }
+                if (key == "device") { r.device = j.string().value_or(""); return true; }
+                return false;
+            });
+        });
+    }
+
+    std::vector<string_port_row> read_string_ports(std::string_view text)
+    {
+        std::vector<string_port_row> outputs;
+        std::vector<string_port_row> serials;
+        json_cursor json(text);
+        if (!json.begin_object()) {
+            return outputs;
+        }
+        std::string_view key;
+        while (json.next_member(key)) {
+            bool const serial = key == "serial";
+            if (key != "outputs" && !serial) {
+                json.skip();
+                continue;
+            }
+            if (!json.begin_array()) {
+                continue;
+            }
+            while (json.next_element()) {
+                auto row = read_fields<string_port_row>(json, [](string_port_row& r, std::string_view k, json_cursor& j) {
+                    if (k == "pin") { r.pin = j.string().value_or(""); return true; }
+                    return false;
+                });
+                row.serial = serial;
+                (serial ? serials : outputs).push_back(std::move(row));
+            }
+        }
+        // outputs are listed before serial ports regardless of their order in the file
+        outputs.insert(outputs.end(), std::make_move_iterator(serials.begin()), std::make_move_iterator(serials.end()));
+        return checked(json, std::move(outputs));
+    }
+
+    cape_files read_folder(std::string const& folder)
+    {
+        cape_files files;
+        std::filesystem::path const root(folder);
+        files.info = read_file(root / "cape-info.json");
+        if (auto const text = read_file(root / "defaults" / "config" / "gpio.json")) {
+            files.gpio = read_gpio(*text);
+        }
+        else if (auto const inputs = read_file(root / "cape-inputs.json")) {
+            files.inputs = read_inputs(*inputs);
+        }
+        if (auto const text = read_file(root / "defaults" / "config" / "co-other.json")) {
+            files.other = read_other(*text);
+        }
+
+        std::error_code ec;
+        for (auto const& entry : std::filesystem::directory_iterator(root / "strings", ec)) {
+            if (entry.path().extension() != ".json" || !entry.is_regular_file(ec)) {
+                continue;
+            }
+            if (auto const text = read_file(entry.path())) {
+                files.strings.emplace_back(entry.path().filename().string(), read_string_ports(*text));
+            }
+        }
+        std::sort(files.strings.begin(), files.strings.end(), [](auto const& a, auto const& b) { return a.first < b.first; });
+        return files;
+    }
+
+    url_list read_vendors(std::string_view text)
+    {
+        url_list vendors;
+        json_cursor json(text);
+        if (!json.begin_object()) {
+            return vendors;
+        }
+        std::string_view key;
+        while (json.next_member(key)) {
+            if (key != "vendors") {
+                json.skip();
+                continue;
+            }
+            if (!json.begin_object()) {
+                continue;
+            }
+            std::string_view vendor;
+            while (json.next_member(vendor)) {
+                std::string name(vendor);
+                vendors.emplace_back(std::move(name), read_url(json));
+            }
+        }
+        return checked(json, std::move(vendors));
+    }
+
+    url_list read_firmware(std::string_view text)
+    {
+        url_list capes;
+        json_cursor json(text);
+        if (!json.begin_object()) {
+            return capes;
+        }
+        std::string_view key;
+        while (json.next_member(key)) {
+            if (key != "capes") {
+                json.skip();
+                continue;
+            }
+            if (!json.begin_object()) {
+                continue;
+            }
+            std::string_view cape;
+            while (json.next_member(cape)) {
+                std::string const capeName(cape);
+                if (!json.begin_object()) {
+                    continue;
+                }
+                std::string_view member;
+                while (json.next_member(member)) {
+                    if (member != "versions") {
+                        json.skip();
+                        continue;
+                    }
+                    if (!json.begin_object()) {
+                        continue;
+                    }
+                    std::string_view version;
+                    while (json.next_member(version)) {
+                        std::string name = capeName + "_" + std::string(version);
+                        capes.emplace_back(std::move(name), read_url(json));
+                    }
+                }
+            }
+        }
+        return checked(json, std::move(capes));
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef CAPE_CONFIG_H
+#define CAPE_CONFIG_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Typed rows for the extracted cape config files, decoded with json_cursor.
+// Only the keys the views show are read, everything else is skipped.
+// A document that does not parse gives no rows, as QJsonDocument did.
+namespace cape_config
+{
+	// defaults/config/gpio.json and cape-inputs.json
+	struct gpio_row
+	{
+		std::string pin;
+		std::string mode;
+		std::string desc;
+		std::string edge;
+		std::string command;
+		std::string arg;
+		std::string type;
+	};
+
+	// defaults/config/co-other.json
+	struct other_row
+	{
+		std::string type;
+		std::string device;
+	};
+
+	// strings/*.json
+	struct string_port_row
+	{
+		bool serial{ false };
+		std::string pin;
+	};
+
+	using url_list = std::vector<std::pair<std::string, std::string>>;
+
+	std::vector<gpio_row> read_gpio(std::string_view json);
+	std::vector<gpio_row> read_inputs(std::string_view json);
+	std::vector<other_row> read_other(std::string_view json);
+	std::vector<string_port_row> read_string_ports(std::string_view json);
+
+	// Everything the views show for one extracted cape folder, read once when the image is loaded.
+	// Files that are missing or cannot be read stay empty.
+	struct cape_files
+	{
+		std::optional<std::string> info;                     // cape-info.json, shown as is
+		std::optional<std::vector<gpio_row>> gpio;           // defaults/config/gpio.json
+		std::optional<std::vector<gpio_row>> inputs;         // cape-inputs.json, only read without gpio.json
+		std::optional<std::vector<other_row>> other;         // defaults/config/co-other.json
+		std::vector<std::pair<std::string, std::vector<string_port_row>>> strings;   // strings/*.json by file name
+	};
+
+	cape_files read_folder(std::string const& folder);
+
+	// eepromVendors.json, vendor name to catalog url
+	url_list read_vendors(std::string_view json);
+	// vendor catalog, "<cape>_<version>" to eeprom url
+	url_list read_firmware(std::string_view json);
+};
+
+#endif // CAPE_CONFIG_H
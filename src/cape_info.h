@@ -9,6 +9,8 @@ struct cape_info
 	std::string version;
 	std::string serialNumber;
 	std::string folder;
+	std::string extractDir;
+	std::string error;
 
 	std::string AsString() const
 	{
@@ -1,7 +1,18 @@
 #include "cape_utils.h"
+#include "eeprom_device.h"
+#include "eeprom_reader.h"
+#include "extraction_manager.h"
+#include "fpp_layout.h"
+#include "parse_workspace.h"
+#include "section_handlers.h"
+#include "section_scanner.h"
 #include <iostream>
 #include <filesystem>
+#include <algorithm>
 #include <array>
+#include <cctype>
+#include <chrono>
+#include <vector>
 #include <QProcess>
 
 #include "spdlog/spdlog.h"
@@ -42,139 +53,222 @@ namespace cape_utils
         {    ++pos;}
         return str.substr(pos);
     }
-    std::string read_string(FILE* file, int len) {
-        std::string buf;
-        buf.reserve(len + 1);
-        buf.resize(len);
-        fread(&buf[0], 1, len, file);
-        return trim(buf);
-    }
 
-    void put_file_contents(const std::string& path, const uint8_t* data, int len) {
+    bool put_file_contents(const std::string& path, const uint8_t* data, int len) {
         FILE* f = fopen(path.c_str(), "w+b");
-        fwrite(data, 1, len, f);
+        if (f == nullptr) {
+            return false;
+        }
+        bool const written = fwrite(data, 1, len, f) == static_cast<size_t>(len);
         fclose(f);
+        return written;
+    }
+
+    bool next_component(std::string_view& rest, std::string_view& part) {
+        while (!rest.empty()) {
+            std::size_t const end = std::min(rest.find_first_of("/\\"), rest.size());
+            part = rest.substr(0, end);
+            rest.remove_prefix(std::min(end + 1, rest.size()));
+            if (!part.empty() && part != ".") {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::optional<std::filesystem::path> section_path(std::string const& root, std::string_view name) {
+        // section paths come straight from the image, only accept plain relative paths.
+        // Checked on the raw name so a rejected section costs no allocation.
+        if (name.empty() || std::any_of(name.begin(), name.end(), [](char c) { return std::iscntrl(static_cast<unsigned char>(c)); })) {
+            return std::nullopt;
+        }
+        // absolute, or a drive or UNC path on Windows
+        if (name.front() == '/' || name.front() == '\\' || (name.size() > 1 && name[1] == ':')) {
+            return std::nullopt;
+        }
+        std::string_view rest = name;
+        std::string_view part;
+        while (next_component(rest, part)) {
+            if (part == "..") {
+                return std::nullopt;
+            }
+        }
+        // has to name a file, not a folder
+        std::string_view const file = name.substr(name.find_last_of("/\\") + 1);
+        if (file.empty() || file == ".") {
+            return std::nullopt;
+        }
+        // an archive unpacked by an earlier section may have left a symlink on the way
+        std::filesystem::path target(root);
+        target /= name;
+        if (!is_within(root, target)) {
+            return std::nullopt;
+        }
+        return target;
+    }
+
+    bool is_within(std::string const& root, std::filesystem::path const& path) {
+        std::error_code ec;
+        std::filesystem::path const base = std::filesystem::weakly_canonical(root, ec);
+        if (ec) {
+            return false;
+        }
+        std::filesystem::path const resolved = std::filesystem::weakly_canonical(path, ec);
+        if (ec) {
+            return false;
+        }
+        std::filesystem::path const rel = resolved.lexically_relative(base);
+        return !rel.empty() && *rel.begin() != "..";
+    }
+
+    std::string extraction_dir(std::string const& EEPROM) {
+        std::error_code ec;
+        std::filesystem::path eeprompath = std::filesystem::absolute(EEPROM, ec);
+        if (ec) {
+            eeprompath = EEPROM;
+        }
+        return eeprompath.parent_path().string() + "/" + eeprompath.stem().string() + "/";
     }
 
     cape_info parseEEPROM(std::string const& EEPROM) {
-        cape_info info;
-        std::filesystem::path eeprompath(EEPROM);
-        std::string eepromdir = eeprompath.parent_path().string();
+        // pool threads and batch runs parse many images, keep their scratch memory around
+        thread_local parse_workspace workspace;
+        return parseEEPROM(EEPROM, workspace);
+    }
+
+    cape_info parseEEPROM(std::string const& EEPROM, parse_workspace& workspace) {
+        std::string const eepromdir = extraction_dir(EEPROM);
+        bool prepared{ false };
         try 
         {
-            eepromdir += "/";
-            eepromdir += eeprompath.stem().string();
-            eepromdir += "/";
-            if(std::filesystem::exists(eepromdir))
-            {
-                std::filesystem::remove_all(eepromdir);
-            }
-            std::filesystem::create_directories(eepromdir);
+            // the previous extraction is moved aside and deleted in the background
+            extraction_manager::instance().prepare(eepromdir);
+            prepared = true;
         }
         catch (std::exception const& ex)
         {
             auto logger = spdlog::get("capeeepromviewer");
-            logger->error("Failed to create eeprom dir: {}", ex.what());
+            if (logger) {
+                logger->error("Failed to create eeprom dir: {}", ex.what());
+            }
         }
         catch (...)
         {
             auto logger = spdlog::get("capeeepromviewer");
-            logger->error("Failed to create eeprom dir: {}", eepromdir);
+            if (logger) {
+                logger->error("Failed to create eeprom dir: {}", eepromdir);
+            }
+        }
+        cape_info info = parseEEPROM(EEPROM, eepromdir, workspace);
+        if (!prepared) {
+            info.extractDir.clear();
+        }
+        return info;
+    }
+
+    cape_info parseEEPROM(std::string const& EEPROM, std::string const& extractDir, parse_workspace& workspace) {
+        workspace.reset();
+        cape_info info;
+        std::error_code ec;
+        std::filesystem::create_directories(extractDir, ec);
+        info.extractDir = extractDir;
+
+        std::vector<uint8_t>& image = workspace.image();
+        image.resize(fpp_layout::max_image_size);
+        FILE* file = fopen(EEPROM.c_str(), "rb");
+        if (file == nullptr) {
+            info.error = "unable to open " + EEPROM;
+            auto logger = spdlog::get("capeeepromviewer");
+            if (logger) {
+                logger->error("Failed to open eeprom {}", EEPROM);
+            }
+            return info;
+        }
+        image.resize(fread(image.data(), 1, image.size(), file));
+        fclose(file);
+
+        eeprom_reader reader(image.data(), image.size());
+        auto const magic = reader.text(fpp_layout::magic.length);
+        if (!magic || !magic->starts_with(fpp_layout::magic_value)) {
+            info.error = "missing " + std::string(fpp_layout::magic_value) + " header";
+            return info;
+        }
+
+        auto const name = reader.text(fpp_layout::name.length);
+        auto const version = reader.text(fpp_layout::version.length);
+        auto const serial = reader.text(fpp_layout::serial.length);
+        if (name && version && serial) {
+            info.name = *name;
+            info.version = *version;
+            info.serialNumber = *serial;
+        }
+
+        section_registry const& registry = section_registry::defaults();
+        auto const start = std::chrono::steady_clock::now();
+
+        // first pass only records where each section is, the payloads are decoded afterwards
+        std::pmr::vector<eeprom_section>& sections = workspace.sections();
+        std::string scanError = reader.diagnostic();
+        if (scanError.empty()) {
+            memory_section_source source(image);
+            scanError = scan_sections(source, registry, sections);
+        }
+        for (auto& section : sections) {
+            section.data = image.data() + section.payload_offset;
         }
 
         try
         {
-            uint8_t* buffer = new uint8_t[32768]; //32K is the largest eeprom we support, more than enough
-            FILE* file = fopen(EEPROM.c_str(), "rb");
-            if (file == nullptr) {
-                return info;
-            }
-            int l = fread(buffer, 1, 6, file);
-
-            if (buffer[0] == 'F' && buffer[1] == 'P' && buffer[2] == 'P' && buffer[3] == '0' && buffer[4] == '2') {
-                info.name = read_string(file, 26);   // cape name + nulls
-                info.version = read_string(file, 10);  // cape version + nulls
-                info.serialNumber = read_string(file, 16); // cape serial# + nulls
-
-                std::string flenStr = read_string(file, 6); //length of the section
-                int flen = std::stoi(flenStr);
-                while (flen) {
-                    int flag = std::stoi(read_string(file, 2));
-                    std::string path{ eepromdir };
-                    if (flag < 50) {
-                        path += read_string(file, 64);
-                    }
-                    switch (flag) {
-                    case 0:
-                    case 1:
-                    case 2:
-                    case 3: {
-                        int l = fread(buffer, 1, flen, file);
-
-                        char* s1 = strdup(path.c_str());
-                        std::filesystem::path p(s1);
-                        std::string dir = p.parent_path().filename().string();
-                        std::filesystem::create_directories(eepromdir + dir);
-                        info.folder = eepromdir + dir;
-                        put_file_contents(path, buffer, flen);
-                        free(s1);
-                        if (flag == 1) {
-                            QString const cmd = "unzip";
-                            exec(cmd, QStringList() << "-x" << path.c_str(), QString::fromStdString(eepromdir + dir));
-                        }
-                        else if (flag == 2) {
-                            QString const cmd = "tar";
-                            exec(cmd, QStringList() << "-xzvf" << path.c_str(), QString::fromStdString(eepromdir + dir));
-                        }
-                        else if (flag == 3) {
-                            QString const cmd = "tar";
-                            exec(cmd, QStringList() << "-xzvf" << path.c_str(), QString::fromStdString(eepromdir + dir));
-                        }
-                        break;
-                    }
-                    case 96: {
-                        info.serialNumber = read_string(file, 16);
-                        read_string(file, 42);
-                        break;
-                    }
-                    case 97: {
-                        read_string(file, 12);
-                        read_string(file, flen - 12);
-                        break;
-                    }
-                    case 98: {
-                        read_string(file, 2);
-                        break;
-                    }
-                    case 99: {
-                        read_string(file, 6);
-                        fread(buffer, 1, flen - 6, file);
-                        break;
-                    }
-                    default:
-                        fseek(file, flen, SEEK_CUR);
-                    }
-                    flenStr = read_string(file, 6); //length of the section
-                    if(flenStr.empty())
-                    {
-                        break;
+            auto const results = registry.decode(sections, extractDir, workspace.resource());
+            for (auto const& result : results) {
+                if (!result.folder.empty()) {
+                    info.folder = result.folder;
+                }
+                if (result.serialNumber) {
+                    info.serialNumber = *result.serialNumber;
+                }
+                if (!result.error.empty()) {
+                    info.error = result.error;
+                    auto logger = spdlog::get("capeeepromviewer");
+                    if (logger) {
+                        logger->error("Failed to extract section in {}: {}", EEPROM, result.error);
                     }
-                    flen = std::stoi(flenStr);
                 }
             }
-            fclose(file);
-            delete[] buffer;
         }
         catch (std::exception const& ex)
         {
             auto logger = spdlog::get("capeeepromviewer");
-            logger->error("Failed to extract eeprom: {}", ex.what());
+            if (logger) {
+                logger->error("Failed to extract eeprom: {}", ex.what());
+            }
         }
         catch (...)
         {
             auto logger = spdlog::get("capeeepromviewer");
-            logger->error("Failed to extract eeprom: {}", EEPROM);
+            if (logger) {
+                logger->error("Failed to extract eeprom: {}", EEPROM);
+            }
+        }
+
+        auto const elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        auto logger = spdlog::get("capeeepromviewer");
+        if (logger) {
+            logger->debug("Extracted {} sections from {} in {} ms, {} arena spills", sections.size(), EEPROM, elapsed.count(), workspace.spills());
+        }
+
+        if (!scanError.empty()) {
+            info.error = scanError;
+            if (logger) {
+                logger->error("Failed to decode eeprom {}: {}", EEPROM, info.error);
+            }
         }
         return info;
     }
+
+    cape_info probeEEPROM(std::string const& EEPROM) {
+        eeprom_device device(EEPROM);
+        device.open();
+        return device.info();
+    }
 }
\ No newline at end of file
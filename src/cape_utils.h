@@ -2,15 +2,29 @@
 #define CAPE_UTILS_H
 
 #include <QString>
+#include <filesystem>
+#include <optional>
+#include <string_view>
 #include "cape_info.h"
 
+class parse_workspace;
+
 namespace cape_utils
 {
 	QString exec(const QString& cmd, const QStringList& args, const QString& dir);
 	std::string trim(std::string str);
-    std::string read_string(FILE* file, int len);
-	void put_file_contents(const std::string& path, const uint8_t* data, int len);
+	bool put_file_contents(const std::string& path, const uint8_t* data, int len);
+	// next component of a section path, skipping empty and "." ones, false once the path is used up
+	bool next_component(std::string_view& rest, std::string_view& part);
+	std::optional<std::filesystem::path> section_path(std::string const& root, std::string_view name);
+	bool is_within(std::string const& root, std::filesystem::path const& path);
+	std::string extraction_dir(std::string const& EEPROM);
 	cape_info parseEEPROM(std::string const& EEPROM);
+	cape_info parseEEPROM(std::string const& EEPROM, parse_workspace& workspace);
+	// extracts into extractDir as is, without going through the extraction manager.
+	// The section table is left in workspace.sections().
+	cape_info parseEEPROM(std::string const& EEPROM, std::string const& extractDir, parse_workspace& workspace);
+	cape_info probeEEPROM(std::string const& EEPROM);
 };
 
 #endif // CAPE_UTILS_H
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "eeprom_device.h"
+#include "eeprom_reader.h"
+#include "fpp_layout.h"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+
+eeprom_device::eeprom_device(std::string path)
+    : m_path(std::move(path))
+{
+}
+
+eeprom_device::~eeprom_device()
+{
+    close();
+}
+
+bool eeprom_device::open()
+{
+    close();
+    m_file = fopen(m_path.c_str(), "rb");
+    if (m_file == nullptr) {
+        return fail("unable to open " + m_path);
+    }
+    // stdio would otherwise read ahead a whole buffer, which is several KB of bus traffic
+    setvbuf(m_file, nullptr, _IONBF, 0);
+
+    // sysfs reports the size of the eeprom itself, anything past that is never read
+    std::error_code ec;
+    std::uintmax_t const fileSize = std::filesystem::file_size(m_path, ec);
+    m_size = ec ? fpp_layout::max_image_size : static_cast<std::size_t>(std::min<std::uintmax_t>(fileSize, fpp_layout::max_image_size));
+
+    std::array<uint8_t, fpp_layout::probe_block_size> block{};
+    std::size_t const len = fread(block.data(), 1, block.size(), m_file);
+
+    eeprom_reader reader(block.data(), len);
+    auto const magic = reader.text(fpp_layout::magic.length);
+    if (!magic || !magic->starts_with(fpp_layout::magic_value)) {
+        release();
+        return fail("missing " + std::string(fpp_layout::magic_value) + " header");
+    }
+    auto const name = reader.text(fpp_layout::name.length);
+    auto const version = reader.text(fpp_layout::version.length);
+    auto const serial = reader.text(fpp_layout::serial.length);
+    if (!name || !version || !serial) {
+        release();
+        return fail(reader.diagnostic());
+    }
+    m_info.name = *name;
+    m_info.version = *version;
+    m_info.serialNumber = *serial;
+    return true;
+}
+
+std::span<eeprom_section const> eeprom_device::sections()
+{
+    if (m_scanned || m_file == nullptr) {
+        return m_sections;
+    }
+    m_scanned = true;
+
+    std::string const error = scan_sections(*this, section_registry::defaults(), m_sections);
+    if (!error.empty()) {
+        fail(error);
+    }
+    return m_sections;
+}
+
+std::vector<uint8_t> eeprom_device::read_section(eeprom_section const& section)
+{
+    std::vector<uint8_t> data(section.size);
+    if (!read_at(section.payload_offset, data.data(), data.size())) {
+        fail("unable to read section at offset " + std::to_string(section.offset));
+        data.clear();
+    }
+    return data;
+}
+
+section_result eeprom_device::extract(eeprom_section const& section, std::string const& eepromdir)
+{
+    section_result result;
+    if (section.handler == nullptr) {
+        return result;
+    }
+    auto const data = read_section(section);
+    if (data.size() != section.size) {
+        result.error = error();
+        return result;
+    }
+    eeprom_section loaded = section;
+    loaded.data = data.data();
+    section.handler->decode(loaded, eepromdir, result);
+    return result;
+}
+
+std::span<const uint8_t> eeprom_device::read(std::size_t offset, std::size_t len)
+{
+    // kept for the life of the device, section names point into these
+    std::vector<uint8_t>& data = m_reads.emplace_back(std::min(len, offset < m_size ? m_size - offset : 0));
+    if (m_file == nullptr || fseek(m_file, static_cast<long>(offset), SEEK_SET) != 0) {
+        data.clear();
+    }
+    else {
+        data.resize(fread(data.data(), 1, data.size(), m_file));
+    }
+    return data;
+}
+
+void eeprom_device::close()
+{
+    release();
+    m_size = 0;
+    m_info = cape_info();
+    m_scanned = false;
+    m_sections.clear();
+    m_reads.clear();
+}
+
+void eeprom_device::release()
+{
+    // closes the file but keeps the info and error, e.g. after a bad header
+    if (m_file != nullptr) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool eeprom_device::read_at(std::size_t offset, uint8_t* data, std::size_t len)
+{
+    if (m_file == nullptr || fseek(m_file, static_cast<long>(offset), SEEK_SET) != 0) {
+        return false;
+    }
+    return fread(data, 1, len, m_file) == len;
+}
+
+bool eeprom_device::fail(std::string const& message)
+{
+    if (m_info.error.empty()) {
+        m_info.error = message;
+    }
+    return false;
+}
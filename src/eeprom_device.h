@@ -0,0 +1,58 @@
+#ifndef EEPROM_DEVICE_H
+#define EEPROM_DEVICE_H
+
+#include "cape_info.h"
+#include "section_handlers.h"
+#include "section_scanner.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <vector>
+
+// Reads an FPP02 image in place, e.g. /sys/bus/i2c/devices/*/eeprom, where every byte costs bus time.
+// open() only reads the header, sections() only reads section headers and seeks over the payloads.
+// A regular image file works the same way.
+class eeprom_device : public section_source
+{
+public:
+	explicit eeprom_device(std::string path);
+	~eeprom_device() override;
+
+	eeprom_device(eeprom_device const&) = delete;
+	eeprom_device& operator=(eeprom_device const&) = delete;
+
+	// reopening starts over, everything read before is dropped
+	bool open();
+	cape_info const& info() const { return m_info; }
+	std::string const& error() const { return m_info.error; }
+
+	// the whole section table, names point into the headers kept by the device.
+	// Sections without a handler are listed too, extract() leaves them alone.
+	std::span<eeprom_section const> sections();
+	std::vector<uint8_t> read_section(eeprom_section const& section);
+	section_result extract(eeprom_section const& section, std::string const& eepromdir);
+
+	std::size_t size() const override { return m_size; }
+	std::span<const uint8_t> read(std::size_t offset, std::size_t len) override;
+
+private:
+	void close();
+	void release();
+	bool read_at(std::size_t offset, uint8_t* data, std::size_t len);
+	bool fail(std::string const& message);
+
+	std::string m_path;
+	FILE* m_file{ nullptr };
+	std::size_t m_size{ 0 };
+	cape_info m_info;
+
+	bool m_scanned{ false };
+	std::deque<std::vector<uint8_t>> m_reads;
+	std::pmr::vector<eeprom_section> m_sections;
+};
+
+#endif // EEPROM_DEVICE_H
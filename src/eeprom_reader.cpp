@@ -0,0 +1,106 @@
+#include "eeprom_reader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+eeprom_reader::eeprom_reader(const uint8_t* data, std::size_t size)
+    : m_data(data)
+    , m_size(size)
+{
+}
+
+std::optional<std::string_view> eeprom_reader::text(std::size_t len)
+{
+    if (failed())
+    {
+        return std::nullopt;
+    }
+    if (len > remaining())
+    {
+        fail(m_offset, "field runs past end of image");
+        return std::nullopt;
+    }
+    std::string_view field(reinterpret_cast<const char*>(m_data + m_offset), len);
+    m_offset += len;
+    return trim(field);
+}
+
+std::optional<int> eeprom_reader::number(std::size_t len)
+{
+    std::size_t const start = m_offset;
+    auto const field = text(len);
+    if (!field)
+    {
+        return std::nullopt;
+    }
+    int value{ 0 };
+    auto const [ptr, ec] = std::from_chars(field->data(), field->data() + field->size(), value);
+    if (field->empty() || ec != std::errc() || ptr != field->data() + field->size() || value < 0)
+    {
+        fail(start, "expected decimal number");
+        return std::nullopt;
+    }
+    return value;
+}
+
+const uint8_t* eeprom_reader::bytes(std::size_t len)
+{
+    if (failed())
+    {
+        return nullptr;
+    }
+    if (len > remaining())
+    {
+        fail(m_offset, "data runs past end of image");
+        return nullptr;
+    }
+    const uint8_t* data = m_data + m_offset;
+    m_offset += len;
+    return data;
+}
+
+bool eeprom_reader::skip(std::size_t len)
+{
+    return bytes(len) != nullptr;
+}
+
+bool eeprom_reader::at_padding(std::size_t len) const
+{
+    std::size_t const count = std::min(len, remaining());
+    return trim(std::string_view(reinterpret_cast<const char*>(m_data + m_offset), count)).empty();
+}
+
+std::string eeprom_reader::diagnostic() const
+{
+    if (!failed())
+    {
+        return {};
+    }
+    return std::string(m_error) + " at offset " + std::to_string(m_errorOffset);
+}
+
+std::string_view eeprom_reader::trim(std::string_view str)
+{
+    // remove trailing white space and null padding
+    while (!str.empty() && (std::isspace(static_cast<unsigned char>(str.back())) || str.back() == 0))
+    {
+        str.remove_suffix(1);
+    }
+    // remove leading white space
+    while (!str.empty() && std::isspace(static_cast<unsigned char>(str.front())))
+    {
+        str.remove_prefix(1);
+    }
+    return str;
+}
+
+bool eeprom_reader::fail(std::size_t at, const char* what)
+{
+    if (!failed())
+    {
+        m_error = what;
+        m_errorOffset = at;
+    }
+    return false;
+}
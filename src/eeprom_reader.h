@@ -0,0 +1,46 @@
+#ifndef EEPROM_READER_H
+#define EEPROM_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Non-throwing cursor over an in-memory EEPROM image.
+// Text fields are returned as views into the image, so decoding does not allocate.
+// The first failure is latched together with the offset it happened at.
+class eeprom_reader
+{
+public:
+	eeprom_reader(const uint8_t* data, std::size_t size);
+
+	std::optional<std::string_view> text(std::size_t len);
+	std::optional<int> number(std::size_t len);
+	const uint8_t* bytes(std::size_t len);
+	bool skip(std::size_t len);
+
+	std::size_t offset() const { return m_offset; }
+	std::size_t remaining() const { return m_size - m_offset; }
+	bool at_end() const { return m_offset >= m_size; }
+	bool at_padding(std::size_t len) const;
+
+	bool failed() const { return m_error != nullptr; }
+	std::size_t error_offset() const { return m_errorOffset; }
+	std::string_view error() const { return m_error ? m_error : ""; }
+	std::string diagnostic() const;
+
+	static std::string_view trim(std::string_view str);
+
+private:
+	bool fail(std::size_t at, const char* what);
+
+	const uint8_t* m_data;
+	std::size_t m_size;
+	std::size_t m_offset{ 0 };
+
+	const char* m_error{ nullptr };
+	std::size_t m_errorOffset{ 0 };
+};
+
+#endif // EEPROM_READER_H
@@ -0,0 +1,356 @@
+#include "extraction_manager.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    // idle interval between quota checks
+    constexpr auto collect_interval = std::chrono::minutes(5);
+    // folders used this recently are never evicted, a load may still be writing to them
+    constexpr auto grace_period = std::chrono::minutes(1);
+
+    std::string key(std::string const& dir)
+    {
+        std::filesystem::path path = std::filesystem::path(dir).lexically_normal();
+        if (!path.has_filename()) {
+            path = path.parent_path();
+        }
+        return path.string();
+    }
+
+    std::uintmax_t dir_size(std::string const& dir)
+    {
+        std::uintmax_t size{ 0 };
+        std::error_code ec;
+        for (auto it = std::filesystem::recursive_directory_iterator(dir, std::filesystem::directory_options::skip_permission_denied, ec);
+             !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            std::error_code sizeEc;
+            if (it->is_regular_file(sizeEc)) {
+                auto const fileSize = it->file_size(sizeEc);
+                if (!sizeEc) {
+                    size += fileSize;
+                }
+            }
+        }
+        return size;
+    }
+
+    struct index_contents
+    {
+        std::map<std::string, std::chrono::system_clock::time_point> lastUsed;
+        std::vector<std::string> trash;
+    };
+
+    index_contents read_index(std::string const& indexFile)
+    {
+        index_contents contents;
+        if (indexFile.empty()) {
+            return contents;
+        }
+        std::ifstream index(indexFile);
+        std::string line;
+        while (std::getline(index, line)) {
+            auto const tab = line.find('\t');
+            if (tab == std::string::npos) {
+                continue;
+            }
+            std::string const stamp = line.substr(0, tab);
+            std::string const dir = line.substr(tab + 1);
+            if (stamp == "trash") {
+                contents.trash.push_back(dir);
+                continue;
+            }
+            std::chrono::system_clock::time_point const lastUsed{ std::chrono::seconds(std::strtoll(stamp.c_str(), nullptr, 10)) };
+            auto& item = contents.lastUsed[dir];
+            item = std::max(item, lastUsed);
+        }
+        return contents;
+    }
+
+    void write_index(std::string const& indexFile, std::string const& text)
+    {
+        if (indexFile.empty()) {
+            return;
+        }
+        std::ofstream index(indexFile, std::ios::trunc);
+        index << text;
+    }
+}
+
+extraction_manager& extraction_manager::instance()
+{
+    static extraction_manager manager;
+    return manager;
+}
+
+extraction_manager::extraction_manager()
+{
+    m_worker = std::thread(&extraction_manager::run, this);
+}
+
+extraction_manager::~extraction_manager()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    // returns after at most one remove_all, the rest of the queue is left for the next run
+    m_worker.join();
+}
+
+void extraction_manager::configure(std::string const& indexFile, std::uintmax_t quotaBytes)
+{
+    index_contents const contents = read_index(indexFile);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_indexFile = indexFile;
+        m_quota = quotaBytes;
+        for (auto const& [dir, lastUsed] : contents.lastUsed) {
+            auto& item = m_entries[dir];
+            item.lastUsed = std::max(item.lastUsed, lastUsed);
+        }
+        m_trash.insert(m_trash.end(), contents.trash.begin(), contents.trash.end());
+    }
+    collect();
+}
+
+void extraction_manager::prepare(std::string const& dir)
+{
+    std::string const path = key(dir);
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        // the worker may be evicting this very folder, let it finish first
+        m_retired.wait(lock, [&]() { return m_retiring.count(path) == 0; });
+        // marking it used keeps the quota away from it while it is being replaced
+        m_entries[path].lastUsed = std::chrono::system_clock::now();
+    }
+
+    std::string trash;
+    if (!retire(path, trash)) {
+        // could not be moved aside, e.g. a file in it is still open on Windows
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!trash.empty()) {
+            m_trash.push_back(std::move(trash));
+        }
+        m_dirty = true;
+    }
+    std::filesystem::create_directories(path);
+    m_wake.notify_one();
+}
+
+void extraction_manager::pin(std::string const& dir)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& item = m_entries[key(dir)];
+    ++item.pins;
+    item.lastUsed = std::chrono::system_clock::now();
+}
+
+void extraction_manager::unpin(std::string const& dir)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto const it = m_entries.find(key(dir));
+    if (it != m_entries.end()) {
+        it->second.pins = std::max(0, it->second.pins - 1);
+        it->second.lastUsed = std::chrono::system_clock::now();
+    }
+}
+
+void extraction_manager::collect()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_collect = true;
+    }
+    m_wake.notify_one();
+}
+
+void extraction_manager::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        bool const woken = m_wake.wait_for(lock, collect_interval, [this]() { return m_stop || m_collect || m_dirty || !m_trash.empty(); });
+
+        if (m_stop) {
+            // exit must not wait on remove_all, whatever is still queued is saved as trash and deleted by the next run
+            std::string const indexFile = m_indexFile;
+            std::string const text = index_text();
+            lock.unlock();
+            write_index(indexFile, text);
+            return;
+        }
+
+        if (!woken && !m_failed.empty()) {
+            // give the deletions that failed before another try
+            m_trash.insert(m_trash.end(), m_failed.begin(), m_failed.end());
+            m_failed.clear();
+        }
+
+        if (!m_trash.empty()) {
+            // delete everything queued so far in one go, without holding the lock
+            std::vector<std::string> batch;
+            batch.swap(m_trash);
+            lock.unlock();
+            std::vector<std::string> failed;
+            std::size_t done{ 0 };
+            for (; done < batch.size() && !m_stop; ++done) {
+                std::error_code ec;
+                std::filesystem::remove_all(batch[done], ec);
+                if (ec || std::filesystem::exists(batch[done], ec)) {
+                    failed.push_back(batch[done]);
+                }
+            }
+            lock.lock();
+            // stopped halfway, the rest goes back in the queue and into the index
+            m_trash.insert(m_trash.end(), batch.begin() + done, batch.end());
+            m_failed.insert(m_failed.end(), failed.begin(), failed.end());
+            m_dirty = true;
+        }
+
+        if (!m_stop && (m_collect || !woken)) {
+            m_collect = false;
+            enforce_quota(lock);
+        }
+
+        if (m_dirty) {
+            m_dirty = false;
+            std::string const indexFile = m_indexFile;
+            std::string const text = index_text();
+            lock.unlock();
+            write_index(indexFile, text);
+            lock.lock();
+        }
+    }
+}
+
+void extraction_manager::enforce_quota(std::unique_lock<std::mutex>& lock)
+{
+    if (m_quota == 0) {
+        return;
+    }
+
+    std::vector<std::pair<std::string, entry>> snapshot(m_entries.begin(), m_entries.end());
+    lock.unlock();
+    std::vector<std::uintmax_t> sizes;
+    std::vector<bool> exists;
+    sizes.reserve(snapshot.size());
+    exists.reserve(snapshot.size());
+    for (auto const& [dir, item] : snapshot) {
+        std::error_code ec;
+        exists.push_back(std::filesystem::is_directory(dir, ec));
+        sizes.push_back(exists.back() ? dir_size(dir) : 0);
+    }
+    lock.lock();
+
+    std::uintmax_t total{ 0 };
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < snapshot.size(); ++i) {
+        if (!exists[i]) {
+            // deleted behind our back, forget it unless it was just recreated
+            auto const it = m_entries.find(snapshot[i].first);
+            if (it != m_entries.end() && it->second.pins == 0 && it->second.lastUsed == snapshot[i].second.lastUsed) {
+                m_entries.erase(it);
+                m_dirty = true;
+            }
+            continue;
+        }
+        total += sizes[i];
+        order.push_back(i);
+    }
+
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return snapshot[a].second.lastUsed < snapshot[b].second.lastUsed;
+    });
+
+    auto const now = std::chrono::system_clock::now();
+    std::vector<std::string> victims;
+    for (std::size_t const i : order) {
+        if (total <= m_quota) {
+            break;
+        }
+        auto const it = m_entries.find(snapshot[i].first);
+        if (it == m_entries.end() || it->second.pins > 0 || it->second.lastUsed != snapshot[i].second.lastUsed ||
+            now - it->second.lastUsed < grace_period) {
+            continue;
+        }
+        // prepare() waits on m_retiring, so the folder cannot be recreated while it is moved away
+        m_retiring.insert(it->first);
+        victims.push_back(it->first);
+        m_entries.erase(it);
+        total -= sizes[i];
+    }
+    if (victims.empty()) {
+        return;
+    }
+
+    lock.unlock();
+    std::vector<std::string> trash;
+    for (auto const& dir : victims) {
+        std::string moved;
+        if (retire(dir, moved)) {
+            if (!moved.empty()) {
+                trash.push_back(std::move(moved));
+            }
+            continue;
+        }
+        // cannot be renamed, delete it in place, we are on the worker already
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+    lock.lock();
+
+    m_trash.insert(m_trash.end(), trash.begin(), trash.end());
+    for (auto const& dir : victims) {
+        m_retiring.erase(dir);
+    }
+    m_dirty = true;
+    m_retired.notify_all();
+}
+
+bool extraction_manager::retire(std::string const& dir, std::string& trash)
+{
+    std::error_code ec;
+    if (!std::filesystem::exists(dir, ec)) {
+        return true;
+    }
+    // renaming is cheap and frees the name at once, the contents are deleted later
+    std::filesystem::path const path(dir);
+    std::string const name = "." + path.filename().string() + ".trash" + std::to_string(++m_trashCounter) + "-" +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::filesystem::path const moved = path.parent_path() / name;
+    std::filesystem::rename(path, moved, ec);
+    if (ec) {
+        return false;
+    }
+    trash = moved.string();
+    return true;
+}
+
+std::string extraction_manager::index_text() const
+{
+    std::string text;
+    for (auto const& [dir, item] : m_entries) {
+        text += std::to_string(std::chrono::duration_cast<std::chrono::seconds>(item.lastUsed.time_since_epoch()).count());
+        text += '\t';
+        text += dir;
+        text += '\n';
+    }
+    // failed deletions are kept as trash, so they are retried after a restart too
+    for (auto const* list : { &m_trash, &m_failed }) {
+        for (auto const& dir : *list) {
+            text += "trash\t";
+            text += dir;
+            text += '\n';
+        }
+    }
+    return text;
+}
@@ -0,0 +1,79 @@
+#ifndef EXTRACTION_MANAGER_H
+#define EXTRACTION_MANAGER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Keeps track of the folders parseEEPROM extracts into and cleans them up in the background.
+//
+// prepare() renames an old extraction out of the way and queues it for deletion, so a load
+// never waits on remove_all. Once a quota is configured, the least recently used unpinned
+// folders are evicted when the total size goes over it. Deletions run in batches on a worker
+// thread, and those that fail are retried on the next periodic check. The list of known folders
+// is kept in an index file so it survives restarts. No file system call is made while holding the lock.
+// On shutdown the worker does not drain its queue, undeleted trash is kept in the index instead.
+// Everything that may call prepare() has to be finished before the static instance is destroyed.
+class extraction_manager
+{
+public:
+	static extraction_manager& instance();
+
+	extraction_manager(extraction_manager const&) = delete;
+	extraction_manager& operator=(extraction_manager const&) = delete;
+
+	// quota of 0 disables eviction
+	void configure(std::string const& indexFile, std::uintmax_t quotaBytes);
+
+	// empties dir for a fresh extraction and starts tracking it
+	void prepare(std::string const& dir);
+
+	// pinned folders are in use and never evicted
+	void pin(std::string const& dir);
+	void unpin(std::string const& dir);
+
+	// wakes the worker to enforce the quota now
+	void collect();
+
+private:
+	struct entry
+	{
+		std::chrono::system_clock::time_point lastUsed;
+		int pins{ 0 };
+	};
+
+	extraction_manager();
+	~extraction_manager();
+
+	void run();
+	void enforce_quota(std::unique_lock<std::mutex>& lock);
+	bool retire(std::string const& dir, std::string& trash);
+	std::string index_text() const;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_retired;
+	std::map<std::string, entry> m_entries;
+	std::vector<std::string> m_trash;
+	// deletions that failed, retried on the next periodic check
+	std::vector<std::string> m_failed;
+	// folders the worker is evicting, prepare() waits for them
+	std::set<std::string> m_retiring;
+	std::string m_indexFile;
+	std::uintmax_t m_quota{ 0 };
+	std::atomic<unsigned> m_trashCounter{ 0 };
+	bool m_dirty{ false };
+	bool m_collect{ false };
+	// also read by the worker while it deletes without the lock
+	std::atomic<bool> m_stop{ false };
+	std::thread m_worker;
+};
+
+#endif // EXTRACTION_MANAGER_H
@@ -0,0 +1,51 @@
+#ifndef FPP_LAYOUT_H
+#define FPP_LAYOUT_H
+
+#include <cstddef>
+#include <string_view>
+
+// Byte layout of an FPP02 cape EEPROM image.
+//
+//  header:  magic[6] name[26] version[10] serial[16]
+//  section: length[6] flag[2] path[64] (only when flag < 50) data[length]
+//
+// All text and number fields are ASCII, padded with nulls.
+namespace fpp_layout
+{
+	struct field
+	{
+		std::size_t offset;
+		std::size_t length;
+
+		constexpr std::size_t end() const { return offset + length; }
+	};
+
+	inline constexpr std::string_view magic_value{ "FPP02" };
+
+	inline constexpr field magic{ 0, 6 };
+	inline constexpr field name{ magic.end(), 26 };
+	inline constexpr field version{ name.end(), 10 };
+	inline constexpr field serial{ version.end(), 16 };
+
+	inline constexpr std::size_t header_size{ serial.end() };
+
+	// section fields, relative to the start of the section
+	inline constexpr field section_length{ 0, 6 };
+	inline constexpr field section_flag{ section_length.end(), 2 };
+	inline constexpr field section_path{ section_flag.end(), 64 };
+
+	// flags below this value carry a path field
+	inline constexpr int path_flag_limit{ 50 };
+
+	// 32K is the largest eeprom we support, more than enough
+	inline constexpr std::size_t max_image_size{ 32768 };
+
+	// I2C eeproms are read a page at a time, keep probes to a single page
+	inline constexpr std::size_t probe_block_size{ 64 };
+
+	static_assert(header_size == 58, "FPP02 header is 58 bytes");
+	static_assert(section_path.end() == 72, "FPP02 file section header is 72 bytes");
+	static_assert(header_size <= probe_block_size, "FPP02 header fits in one probe block");
+}
+
+#endif // FPP_LAYOUT_H
@@ -0,0 +1,331 @@
+#include "json_cursor.h"
+
+namespace
+{
+    int hex_value(char c)
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool read_hex4(std::string_view text, std::size_t pos, unsigned& value)
+    {
+        if (pos + 4 > text.size()) {
+            return false;
+        }
+        value = 0;
+        for (std::size_t i = pos; i < pos + 4; ++i) {
+            int const digit = hex_value(text[i]);
+            if (digit < 0) {
+                return false;
+            }
+            value = (value << 4) | static_cast<unsigned>(digit);
+        }
+        return true;
+    }
+
+    void append_utf8(std::string& out, unsigned cp)
+    {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        }
+        else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // decodes the escapes in the raw contents of a JSON string, false on a malformed \u escape
+    bool unescape(std::string_view raw, std::string& out)
+    {
+        out.clear();
+        out.reserve(raw.size());
+        for (std::size_t i = 0; i < raw.size(); ++i) {
+            char const c = raw[i];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (++i >= raw.size()) {
+                break;
+            }
+            switch (raw[i]) {
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned cp{ 0 };
+                if (!read_hex4(raw, i + 1, cp)) {
+                    return false;
+                }
+                i += 4;
+                // surrogate pair
+                unsigned low{ 0 };
+                if (cp >= 0xD800 && cp <= 0xDBFF && i + 2 < raw.size() && raw[i + 1] == '\\' && raw[i + 2] == 'u' &&
+                    read_hex4(raw, i + 3, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+                append_utf8(out, cp);
+                break;
+            }
+            default:
+                out += raw[i];
+            }
+        }
+        return true;
+    }
+}
+
+json_cursor::json_cursor(std::string_view text)
+    : m_text(text)
+{
+}
+
+bool json_cursor::begin_object()
+{
+    if (peek() != '{') {
+        skip();
+        return false;
+    }
+    ++m_pos;
+    m_first = true;
+    return true;
+}
+
+bool json_cursor::next_member(std::string_view& key)
+{
+    if (!next('}') || !raw_string(key)) {
+        return false;
+    }
+    // escaped keys are decoded into m_key, plain ones stay views into the text
+    if (key.find('\\') != std::string_view::npos) {
+        if (!unescape(key, m_key)) {
+            return fail();
+        }
+        key = m_key;
+    }
+    return expect(':');
+}
+
+bool json_cursor::begin_array()
+{
+    if (peek() != '[') {
+        skip();
+        return false;
+    }
+    ++m_pos;
+    m_first = true;
+    return true;
+}
+
+bool json_cursor::next_element()
+{
+    return next(']');
+}
+
+std::optional<std::string> json_cursor::string()
+{
+    if (peek() != '"') {
+        skip();
+        return std::nullopt;
+    }
+    std::string_view raw;
+    if (!raw_string(raw)) {
+        return std::nullopt;
+    }
+
+    std::string out;
+    if (!unescape(raw, out)) {
+        fail();
+        return std::nullopt;
+    }
+    return out;
+}
+
+bool json_cursor::skip()
+{
+    char const c = peek();
+    if (c == '"') {
+        std::string_view raw;
+        return raw_string(raw);
+    }
+    if (c == '{' || c == '[') {
+        int depth{ 0 };
+        while (m_pos < m_text.size()) {
+            char const ch = m_text[m_pos];
+            if (ch == '"') {
+                std::string_view raw;
+                if (!raw_string(raw)) {
+                    return false;
+                }
+                continue;
+            }
+            if (ch == '{' || ch == '[') {
+                ++depth;
+            }
+            else if (ch == '}' || ch == ']') {
+                if (--depth == 0) {
+                    ++m_pos;
+                    return true;
+                }
+            }
+            ++m_pos;
+        }
+        return fail();
+    }
+
+    if (c == 't') {
+        return literal("true");
+    }
+    if (c == 'f') {
+        return literal("false");
+    }
+    if (c == 'n') {
+        return literal("null");
+    }
+    return number();
+}
+
+bool json_cursor::finished()
+{
+    return !m_failed && peek() == '\0';
+}
+
+char json_cursor::peek()
+{
+    while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\t' || m_text[m_pos] == '\r' || m_text[m_pos] == '\n')) {
+        ++m_pos;
+    }
+    return m_pos < m_text.size() ? m_text[m_pos] : '\0';
+}
+
+bool json_cursor::expect(char c)
+{
+    if (peek() != c) {
+        return fail();
+    }
+    ++m_pos;
+    return true;
+}
+
+bool json_cursor::next(char close)
+{
+    if (m_failed) {
+        return false;
+    }
+    char const c = peek();
+    if (c == close) {
+        ++m_pos;
+        m_first = false;
+        return false;
+    }
+    if (c == '\0') {
+        // the input ended before the object or array was closed
+        return fail();
+    }
+    if (m_first) {
+        // no comma before the first item
+        m_first = false;
+        return c != ',' || fail();
+    }
+    // and exactly one between items, none after the last
+    if (c != ',') {
+        return fail();
+    }
+    ++m_pos;
+    char const after = peek();
+    if (after == close || after == '\0' || after == ',') {
+        return fail();
+    }
+    return true;
+}
+
+bool json_cursor::raw_string(std::string_view& out)
+{
+    if (!expect('"')) {
+        return false;
+    }
+    std::size_t const start = m_pos;
+    while (m_pos < m_text.size()) {
+        char const ch = m_text[m_pos];
+        if (ch == '\\') {
+            m_pos += 2;
+            continue;
+        }
+        if (ch == '"') {
+            out = m_text.substr(start, m_pos - start);
+            ++m_pos;
+            return true;
+        }
+        ++m_pos;
+    }
+    return fail();
+}
+
+bool json_cursor::literal(std::string_view word)
+{
+    if (m_text.substr(m_pos, word.size()) != word) {
+        return fail();
+    }
+    m_pos += word.size();
+    return true;
+}
+
+bool json_cursor::number()
+{
+    auto const digits = [&]() {
+        std::size_t const start = m_pos;
+        while (m_pos < m_text.size() && m_text[m_pos] >= '0' && m_text[m_pos] <= '9') {
+            ++m_pos;
+        }
+        return m_pos != start;
+    };
+    auto const accept = [&](char c) {
+        if (m_pos < m_text.size() && m_text[m_pos] == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    };
+
+    // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    accept('-');
+    if (!accept('0') && (m_pos >= m_text.size() || m_text[m_pos] < '1' || m_text[m_pos] > '9' || !digits())) {
+        return fail();
+    }
+    if (accept('.') && !digits()) {
+        return fail();
+    }
+    if (accept('e') || accept('E')) {
+        if (!accept('+')) {
+            accept('-');
+        }
+        if (!digits()) {
+            return fail();
+        }
+    }
+    return true;
+}
+
+bool json_cursor::fail()
+{
+    m_failed = true;
+    m_pos = m_text.size();
+    return false;
+}
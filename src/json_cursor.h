@@ -0,0 +1,62 @@
+#ifndef JSON_CURSOR_H
+#define JSON_CURSOR_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Forward-only pull parser over a JSON document.
+// Callers walk objects and arrays, read the values they need and skip the rest,
+// so no DOM is built and only the strings actually read are copied.
+//
+//  json_cursor json(text);
+//  if (json.begin_object()) {
+//      std::string_view key;
+//      while (json.next_member(key)) {
+//          if (key == "pin") pin = json.string().value_or("");
+//          else json.skip();
+//      }
+//  }
+//
+// Every member or element must be consumed (read or skipped) before moving to the next one.
+// Keys are only valid until the next call to next_member().
+// Malformed or truncated input latches failed() and ends all loops.
+class json_cursor
+{
+public:
+	explicit json_cursor(std::string_view text);
+
+	bool begin_object();
+	bool next_member(std::string_view& key);
+
+	bool begin_array();
+	bool next_element();
+
+	// returns nullopt and skips the value when it is not a string
+	std::optional<std::string> string();
+	bool skip();
+
+	bool failed() const { return m_failed; }
+	// true once the whole document has been read without error, trailing text is an error
+	bool finished();
+
+private:
+	char peek();
+	bool expect(char c);
+	bool next(char close);
+	bool raw_string(std::string_view& out);
+	bool literal(std::string_view word);
+	bool number();
+	bool fail();
+
+	std::string_view m_text;
+	std::string m_key;
+	std::size_t m_pos{ 0 };
+	// no member or element read yet in the innermost open object or array.
+	// A closed container always returns to one that has read its first item, so no stack is needed.
+	bool m_first{ false };
+	bool m_failed{ false };
+};
+
+#endif // JSON_CURSOR_H
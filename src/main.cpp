@@ -1,11 +1,76 @@
 #include "mainwindow.h"
 
+#include "cape_audit.h"
+#include "config.h"
+
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QThreadPool>
+
+#include "spdlog/sinks/stdout_sinks.h"
+
+#include <cstring>
+#include <memory>
+
+namespace
+{
+    //the audit runs on headless hosts, so it must not need a display
+    QCoreApplication* createApplication(int& argc, char* argv[])
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--audit") == 0 || std::strncmp(argv[i], "--audit=", 8) == 0)
+            {
+                return new QCoreApplication(argc, argv);
+            }
+        }
+        return new QApplication(argc, argv);
+    }
+}
 
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
+    //startup is measured from here to the first time the window is exposed
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
+    std::unique_ptr<QCoreApplication> a(createApplication(argc, argv));
+    QCoreApplication::setApplicationName(PROJECT_NAME);
+    QCoreApplication::setApplicationVersion(PROJECT_VER);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("View FPP Cape EEPROM Files");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("eeprom", "EEPROM files to open.", "[eeprom...]");
+    QCommandLineOption auditOption("audit", "Write capes.csv, sections.csv and pins.csv for the given EEPROM files or folders to <dir> and exit.", "dir");
+    parser.addOption(auditOption);
+    parser.process(*a);
+
+    if (parser.isSet(auditOption))
+    {
+        spdlog::stderr_logger_mt("capeeepromviewer");
+        std::vector<std::string> paths;
+        for (auto const& path : parser.positionalArguments())
+        {
+            paths.push_back(path.toStdString());
+        }
+        std::string error;
+        if (!cape_audit::export_audit(cape_audit::collect_eeproms(paths), parser.value(auditOption).toStdString(), error))
+        {
+            spdlog::get("capeeepromviewer")->error(error);
+            return 1;
+        }
+        return 0;
+    }
+
     MainWindow w;
+    w.SetStartupTimer(startupTimer);
     w.show();
-    return a.exec();
+    w.OpenEEPROMs(parser.positionalArguments());
+    int const result = a->exec();
+    //loads still running use the extraction manager, which goes away with the other statics
+    QThreadPool::globalInstance()->waitForDone();
+    return result;
 }
@@ -3,6 +3,8 @@
 #include "./ui_mainwindow.h"
 
 #include "cape_utils.h"
+#include "cape_config.h"
+#include "extraction_manager.h"
 
 #include "config.h"
 
@@ -15,12 +17,20 @@
 #include <QListWidgetItem>
 #include <QTableWidget>
 #include <QThread>
+#include <QTabBar>
+#include <QDragEnterEvent>
+#include <QDropEvent>
+#include <QMimeData>
+#include <QFileSystemModel>
+#include <QItemSelectionModel>
+#include <QTextCursor>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QPointer>
 #include <QInputDialog>
 #include <QCommandLineParser>
 #include <QTimer>
-#include <QJsonObject>
-#include <QJsonDocument>
-#include <QJsonArray>
+#include <QWindow>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QStandardPaths>
@@ -31,16 +41,41 @@
 #include "spdlog/sinks/qt_sinks.h"
 #include "spdlog/sinks/rotating_file_sink.h"
 
+#include <algorithm>
 #include <filesystem>
+#include <utility>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
 {
-	QCoreApplication::setApplicationName(PROJECT_NAME);
-    QCoreApplication::setApplicationVersion(PROJECT_VER);
+	m_startupTimer.start();
     ui->setupUi(this);
 
+	setWindowTitle(windowTitle() + " v" + PROJECT_VER);
+	setAcceptDrops(true);
+
+	m_documentTabs = new QTabBar(this);
+	m_documentTabs->setDocumentMode(true);
+	m_documentTabs->setTabsClosable(true);
+	m_documentTabs->setMovable(true);
+	m_documentTabs->setExpanding(false);
+	m_documentTabs->setAutoHide(true);
+	ui->verticalLayout->insertWidget(0, m_documentTabs);
+
+	ui->splitterFiles->setStretchFactor(1, 2);
+
+	connect(ui->comboBoxCape, &QComboBox::currentTextChanged, this, &MainWindow::RedrawStringPortList);
+	connect(ui->tvFiles, &QTreeView::activated, this, &MainWindow::OnFileActivated);
+	connect(ui->tvFiles, &QTreeView::clicked, this, &MainWindow::OnFileActivated);
+	connect(m_documentTabs, &QTabBar::currentChanged, this, &MainWindow::ShowDocument);
+	connect(m_documentTabs, &QTabBar::tabCloseRequested, this, &MainWindow::CloseDocument);
+
+	//everything else touches the disk, it runs once the window is first exposed, see eventFilter
+}
+
+void MainWindow::FinishStartup()
+{
 	auto const log_name{ "log.txt" };
 
 	appdir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
@@ -64,12 +99,13 @@ MainWindow::MainWindow(QWidget *parent)
 		QMessageBox::warning(this, "Logger Failed", "Logger Failed To Start.");
 	}
 
-	setWindowTitle(windowTitle() + " v" + PROJECT_VER);
-
 	settings = std::make_unique< QSettings>(appdir + "/settings.ini", QSettings::IniFormat);
 
+	//extracted folders are tracked across runs and trimmed back to the quota in the background
+	std::uintmax_t const quotaMB = settings->value("extract_quota_mb", 1024).toULongLong();
+	extraction_manager::instance().configure((appdir + "/extracted.txt").toStdString(), quotaMB * 1024 * 1024);
+
 	RedrawRecentList();
-	connect(ui->comboBoxCape, &QComboBox::currentTextChanged, this, &MainWindow::RedrawStringPortList);
 
 	if (QOperatingSystemVersion::current().type() == QOperatingSystemVersion::OSType::Windows)
 	{
@@ -80,6 +116,14 @@ MainWindow::MainWindow(QWidget *parent)
 			QMessageBox::warning(this, "Windows Version Error", "Your Verison of Windows is too old.\nPlease Update to Windows 10 1803 April 2018 Update or Newer");
 		}
 	}
+
+	m_readyMs = m_startupTimer.elapsed();
+	ReportStartup();
+
+	if (!m_pendingFiles.isEmpty())
+	{
+		OpenEEPROMs(std::exchange(m_pendingFiles, QStringList()));
+	}
 }
 
 MainWindow::~MainWindow()
@@ -87,15 +131,44 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
-void MainWindow::on_actionOpen_EEPROM_triggered()
+void MainWindow::SetStartupTimer(QElapsedTimer const& timer)
 {
-	QString const EEPROM = QFileDialog::getOpenFileName(this, "Select EEPROM File", settings->value("last_project").toString(), tr("EEPROM Files (*.bin *.eeprom);;All Files (*.*)"));
-	if (!EEPROM.isEmpty())
+	m_startupTimer = timer;
+}
+
+void MainWindow::showEvent(QShowEvent* event)
+{
+	QMainWindow::showEvent(event);
+	//the window only counts as up once it is exposed on screen
+	if (m_shownMs < 0 && windowHandle())
 	{
-		LoadEEPROM(EEPROM);
+		windowHandle()->installEventFilter(this);
 	}
 }
 
+bool MainWindow::eventFilter(QObject* watched, QEvent* event)
+{
+	if (watched == windowHandle() && event->type() == QEvent::Expose && m_shownMs < 0 && windowHandle()->isExposed())
+	{
+		m_shownMs = m_startupTimer.elapsed();
+		windowHandle()->removeEventFilter(this);
+		//queued so the first frame is painted before the disk work starts
+		QTimer::singleShot(0, this, &MainWindow::FinishStartup);
+	}
+	return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::ReportStartup()
+{
+	LogMessage(QString("Startup v%1: window shown after %2 ms, ready after %3 ms").arg(PROJECT_VER).arg(m_shownMs).arg(m_readyMs), spdlog::level::level_enum::info);
+}
+
+void MainWindow::on_actionOpen_EEPROM_triggered()
+{
+	QStringList const EEPROMs = QFileDialog::getOpenFileNames(this, "Select EEPROM Files", settings->value("last_project").toString(), tr("EEPROM Files (*.bin *.eeprom);;All Files (*.*)"));
+	OpenEEPROMs(EEPROMs);
+}
+
 void MainWindow::on_actionDownload_EEPROM_triggered()
 {
 	bool ssl = QSslSocket::supportsSsl();
@@ -158,12 +231,14 @@ void MainWindow::on_menuRecent_triggered()
 	if (recentItem && !recentItem->data().isNull())
 	{
 		auto const project = qvariant_cast<QString>(recentItem->data());
-		LoadEEPROM(project);
+		OpenEEPROMs(QStringList() << project);
 	}
 }
 
 void MainWindow::on_actionClear_triggered()
 {
+	//drop the result of a check that is still running
+	++m_recentGeneration;
 	ui->menuRecent->clear();
 	settings->remove("Recent_ProjectsList");
 
@@ -171,186 +246,480 @@ void MainWindow::on_actionClear_triggered()
 	ui->menuRecent->addAction(ui->actionClear);
 }
 
+void MainWindow::dragEnterEvent(QDragEnterEvent* event)
+{
+	if (event->mimeData()->hasUrls())
+	{
+		event->acceptProposedAction();
+	}
+}
+
+void MainWindow::dropEvent(QDropEvent* event)
+{
+	QStringList files;
+	for (auto const& url : event->mimeData()->urls())
+	{
+		if (url.isLocalFile())
+		{
+			files.append(url.toLocalFile());
+		}
+	}
+	OpenEEPROMs(files);
+	event->acceptProposedAction();
+}
+
+void MainWindow::OpenEEPROMs(QStringList const& files)
+{
+	//settings are only available once startup has finished
+	if (!settings)
+	{
+		m_pendingFiles.append(files);
+		return;
+	}
+
+	for (auto const& file : files)
+	{
+		QString const filepath = QFileInfo(file).absoluteFilePath();
+		int const index = FindDocument(filepath);
+		if (index != -1)
+		{
+			m_documentTabs->setCurrentIndex(index);
+			continue;
+		}
+		LoadEEPROM(filepath);
+	}
+}
+
 void MainWindow::LoadEEPROM(QString const& filepath)
 {
+	QFileInfo proj(filepath);
+	QString const file = proj.absoluteFilePath();
+
+	QString const owner = ExtractionOwner(file);
+	if (!owner.isEmpty())
+	{
+		QString const message = QString("%1 extracts to the same folder as %2, close it first").arg(proj.fileName(), QFileInfo(owner).fileName());
+		ui->statusbar->showMessage(message);
+		LogMessage(message, spdlog::level::level_enum::warn);
+		return;
+	}
+
 	settings->setValue("last_project", filepath);
 	settings->sync();
+	AddRecentList(file);
 
-	QFileInfo proj(filepath);
-	m_cape = cape_utils::parseEEPROM(filepath.toStdString());
+	int index = FindDocument(file);
+	if (index == -1)
+	{
+		index = m_documentTabs->addTab(proj.fileName());
+		m_documentTabs->setTabData(index, file);
+		m_documentTabs->setTabToolTip(index, file);
+	}
+	m_documentTabs->setTabText(index, proj.fileName() + " (loading)");
 
-	ui->leProject->setText(m_cape.AsString().c_str());
-	
-	AddRecentList(proj.absoluteFilePath());
+	//still extracting, possibly for a tab that was closed meanwhile, the tab picks up that result
+	if (m_loading.contains(file))
+	{
+		m_documentTabs->setCurrentIndex(index);
+		return;
+	}
 
-	ReadCapeInfo(m_cape.folder.c_str());
-	CreateStringsList(m_cape.folder.c_str());
-	ReadGPIOFile(m_cape.folder.c_str());
-	ReadOtherFile(m_cape.folder.c_str());
+	m_loading.insert(file);
+	ReleaseDocument(file);
+
+	if (m_documentTabs->currentIndex() == index)
+	{
+		ShowDocument(index);
+	}
+	else
+	{
+		m_documentTabs->setCurrentIndex(index);
+	}
+
+	//extraction runs external tools, keep it off the UI thread
+	//the config files are decoded here too, so switching tabs only fills the widgets
+	QPointer<MainWindow> self(this);
+	QThreadPool::globalInstance()->start(QRunnable::create([self, file]()
+	{
+		auto document = std::make_shared<cape_document>();
+		document->cape = cape_utils::parseEEPROM(file.toStdString());
+		if (!document->cape.folder.empty())
+		{
+			document->files = cape_config::read_folder(document->cape.folder);
+		}
+		QMetaObject::invokeMethod(qApp, [self, file, document]()
+		{
+			if (self)
+			{
+				self->OnEEPROMLoaded(file, document);
+			}
+		}, Qt::QueuedConnection);
+	}));
 }
 
-void MainWindow::ReadCapeInfo(QString const& folder)
+void MainWindow::OnEEPROMLoaded(QString const& filepath, std::shared_ptr<cape_document const> const& document)
 {
-	ui->textEditCapeInfo->clear();
-	QFile infoFile(folder + "/cape-info.json");
-	if (!infoFile.exists())
+	m_loading.remove(filepath);
+	int const index = FindDocument(filepath);
+	if (index == -1)
+	{
+		return;
+	}
+	m_capes.insert(filepath, document);
+	if (!document->cape.extractDir.empty())
+	{
+		extraction_manager::instance().pin(document->cape.extractDir);
+	}
+	m_documentTabs->setTabText(index, QFileInfo(filepath).fileName());
+
+	//logged once per load, not on every tab switch
+	cape_config::cape_files const& files = document->files;
+	if (!files.info)
 	{
 		LogMessage("cape-info file not found", spdlog::level::level_enum::err);
+	}
+	if (!files.gpio)
+	{
+		LogMessage("file not found gpio.json", spdlog::level::level_enum::err);
+		if (!files.inputs)
+		{
+			LogMessage("file not found cape-inputs.json", spdlog::level::level_enum::err);
+		}
+	}
+	if (!files.other)
+	{
+		LogMessage("file not found co-other.json", spdlog::level::level_enum::err);
+	}
+
+	if (m_documentTabs->currentIndex() == index)
+	{
+		ShowDocument(index);
+	}
+}
+
+void MainWindow::ShowDocument(int index)
+{
+	QString const file = index == -1 ? QString() : m_documentTabs->tabData(index).toString();
+	m_document = m_capes.value(file);
+	if (!m_document)
+	{
+		ui->leProject->clear();
+		ui->textEditCapeInfo->clear();
+		ui->comboBoxCape->clear();
+		ui->twGPIO->clearContents();
+		ui->twGPIO->setRowCount(0);
+		ui->twOther->clearContents();
+		ui->twOther->setRowCount(0);
+		ShowFileTree(QString());
 		return;
 	}
 
-	if (!infoFile.open(QIODevice::ReadOnly))
+	cape_info const& cape = m_document->cape;
+	if (!cape.error.empty())
+	{
+		ui->statusbar->showMessage(QString::fromStdString(cape.error));
+	}
+	else
+	{
+		ui->statusbar->clearMessage();
+	}
+
+	ui->leProject->setText(cape.AsString().c_str());
+
+	ShowCapeInfo();
+	CreateStringsList();
+	ShowGPIO();
+	ShowOther();
+	ShowFileTree(file);
+}
+
+void MainWindow::CloseDocument(int index)
+{
+	//removing the tab switches to another document before this one is released
+	QString const file = m_documentTabs->tabData(index).toString();
+	m_documentTabs->removeTab(index);
+	ReleaseDocument(file);
+}
+
+void MainWindow::ReleaseDocument(QString const& filepath)
+{
+	//the tree model watches the folder it listed, drop it before the folder can be renamed
+	if (QFileSystemModel* model = m_fileModels.take(filepath))
+	{
+		if (ui->tvFiles->model() == model)
+		{
+			SetFileModel(nullptr);
+		}
+		delete model;
+	}
+
+	auto const it = m_capes.find(filepath);
+	if (it == m_capes.end())
 	{
-		LogMessage("Error Opening: cape-info.json" , spdlog::level::level_enum::err);
 		return;
 	}
+	if (!(*it)->cape.extractDir.empty())
+	{
+		extraction_manager::instance().unpin((*it)->cape.extractDir);
+	}
+	m_capes.erase(it);
+}
 
-	QByteArray saveData = infoFile.readAll();
-	ui->textEditCapeInfo->setText(saveData);
+QString MainWindow::ExtractionOwner(QString const& filepath) const
+{
+	//foo.bin and foo.eeprom both extract to foo/, only one of them may use it at a time
+	QString const folder = QString::fromStdString(cape_utils::extraction_dir(filepath.toStdString()));
+	//only file systems that fold case make foo and Foo the same folder
+#if defined(Q_OS_WIN) || defined(Q_OS_MACOS)
+	Qt::CaseSensitivity constexpr folderCase{ Qt::CaseInsensitive };
+#else
+	Qt::CaseSensitivity constexpr folderCase{ Qt::CaseSensitive };
+#endif
+	auto const sameFolder = [&](QString const& other)
+	{
+		return other != filepath &&
+			QString::fromStdString(cape_utils::extraction_dir(other.toStdString())).compare(folder, folderCase) == 0;
+	};
+
+	for (auto const& other : m_loading)
+	{
+		if (sameFolder(other))
+		{
+			return other;
+		}
+	}
+	for (int i = 0; i < m_documentTabs->count(); ++i)
+	{
+		QString const other = m_documentTabs->tabData(i).toString();
+		if (sameFolder(other))
+		{
+			return other;
+		}
+	}
+	return QString();
 }
 
-void MainWindow::CreateStringsList(QString const& folder)
+int MainWindow::FindDocument(QString const& filepath) const
 {
-	QDir directory(folder + "/strings");
-	auto const& stringFiles = directory.entryInfoList(QStringList() << "*.json" , QDir::Files);
+	for (int i = 0; i < m_documentTabs->count(); ++i)
+	{
+		if (m_documentTabs->tabData(i).toString() == filepath)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
 
-	ui->comboBoxCape->clear();
-	
-	for (auto const& file : stringFiles)
+void MainWindow::ShowCapeInfo()
+{
+	ui->textEditCapeInfo->clear();
+	if (m_document->files.info)
 	{
-		ui->comboBoxCape->addItem(file.fileName());
+		ui->textEditCapeInfo->setText(QString::fromStdString(*m_document->files.info));
 	}
 }
 
-void MainWindow::ReadGPIOFile(QString const& folder) 
+void MainWindow::SetFileModel(QFileSystemModel* model)
 {
-	ui->twGPIO->clearContents();
-	ui->twGPIO->setRowCount(0);
-	//C:\Users\scoot\Desktop\BBB16-220513130003-eeprom\tmp\defaults\config\gpio.json
-	auto SetItem = [&](int row, int col, QString const& text)
+	//setModel leaves the old selection model to the caller
+	QItemSelectionModel* selection = ui->tvFiles->selectionModel();
+	ui->tvFiles->setModel(model);
+	delete selection;
+	m_fileModel = model;
+	if (model)
 	{
-		ui->twGPIO->setItem(row, col, new QTableWidgetItem());
-		ui->twGPIO->item(row, col)->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
-		ui->twGPIO->item(row, col)->setText(text);
-	};
+		//only name and size are useful here
+		ui->tvFiles->hideColumn(2);
+		ui->tvFiles->hideColumn(3);
+	}
+}
 
-	QFile jsonFile(folder + "/defaults/config/gpio.json");
-	if (!jsonFile.exists())
+void MainWindow::ShowFileTree(QString const& filepath)
+{
+	OpenFileView(QString());
+	auto const document = m_capes.value(filepath);
+	if (!document || document->cape.extractDir.empty())
 	{
-		LogMessage("file not found gpio.json", spdlog::level::level_enum::err);
-		ReadCapeInputsFile(folder);
+		SetFileModel(nullptr);
 		return;
 	}
-	if (!jsonFile.open(QIODevice::ReadOnly))
+
+	//each document keeps its own model, so switching back does not list the folder again.
+	//It is deleted in ReleaseDocument, before the folder can be renamed.
+	QFileSystemModel* model = m_fileModels.value(filepath);
+	QString const root = QDir::cleanPath(QString::fromStdString(document->cape.extractDir));
+	if (!model)
+	{
+		//the model only lists a folder once it is expanded, so big extractions stay cheap
+		model = new QFileSystemModel(this);
+		model->setReadOnly(true);
+		model->setRootPath(root);
+		m_fileModels.insert(filepath, model);
+	}
+	SetFileModel(model);
+	ui->tvFiles->setRootIndex(model->index(root));
+}
+
+void MainWindow::OnFileActivated(QModelIndex const& index)
+{
+	if (!index.isValid() || !m_fileModel || m_fileModel->isDir(index) || m_fileModel->filePath(index) == m_viewPath)
 	{
-		LogMessage("Error Opening: gpio.json", spdlog::level::level_enum::err);
 		return;
 	}
+	OpenFileView(m_fileModel->filePath(index));
+}
 
-	QByteArray saveData = jsonFile.readAll();
+void MainWindow::OpenFileView(QString const& path)
+{
+	ui->pteFileView->clear();
+	m_viewPath = path;
+	m_viewOffset = 0;
+	m_viewBinary = false;
+	ui->pbLoadMore->setEnabled(false);
+	ui->pbLoadMore->setText("Load More");
+	if (!path.isEmpty())
+	{
+		LoadFilePage();
+	}
+}
 
-	QJsonDocument loadDoc(QJsonDocument::fromJson(saveData));
-	QJsonArray mappingArray = loadDoc.array();
+void MainWindow::on_pbLoadMore_clicked()
+{
+	LoadFilePage();
+}
 
-	ui->twGPIO->setRowCount(static_cast<int>(mappingArray.size()));
-	int row{ 0 };
+void MainWindow::LoadFilePage()
+{
+	//files are read a page at a time and not kept open, so huge files never stall the UI
+	qint64 constexpr pageSize{ 64 * 1024 };
 
-	for (auto const& mapp : mappingArray)
+	QFile file(m_viewPath);
+	if (!file.open(QIODevice::ReadOnly) || !file.seek(m_viewOffset))
 	{
-		QJsonObject mapObj = mapp.toObject();
-		QString pin = mapObj["pin"].toString();
-		QString mode = mapObj["mode"].toString();
-		SetItem(row, 0, pin);
-		SetItem(row, 1, mode);
-		if (mapObj.contains("desc"))
-		{
-			SetItem(row, 2, mapObj["desc"].toString());
-		}
+		LogMessage("Error Opening: " + m_viewPath, spdlog::level::level_enum::err);
+		ui->pbLoadMore->setEnabled(false);
+		return;
+	}
 
-		if (mapObj.contains("rising"))
+	QByteArray page = file.read(pageSize);
+	qint64 const fileSize = file.size();
+	if (m_viewOffset == 0)
+	{
+		m_viewBinary = page.contains('\0');
+	}
+
+	QString text;
+	if (m_viewBinary)
+	{
+		//hex dump, 16 bytes per line
+		for (int i = 0; i < page.size(); i += 16)
 		{
-			SetItem(row, 3, "rising");
-			if (mapObj["rising"].toObject().contains("command")) 
-			{
-				SetItem(row, 4, mapObj["rising"].toObject()["command"].toString());
-			}
-			if (mapObj["rising"].toObject().contains("args") &&
-				mapObj["rising"].toObject()["args"].toArray().size()>0)
-			{
-				SetItem(row, 5, mapObj["rising"].toObject()["args"].toArray()[0].toString());
-			}
+			text += QString("%1  %2\n").arg(m_viewOffset + i, 8, 16, QChar('0')).arg(QString(page.mid(i, 16).toHex(' ')));
 		}
-		else if (mapObj.contains("falling"))
+	}
+	else
+	{
+		//don't split a UTF-8 sequence across pages, the rest comes with the next one
+		if (!page.isEmpty() && m_viewOffset + page.size() < fileSize)
 		{
-			SetItem(row, 3, "falling");
-			if (mapObj["falling"].toObject().contains("command"))
+			int lead = page.size() - 1;
+			while (lead > 0 && lead > page.size() - 4 && (static_cast<unsigned char>(page[lead]) & 0xC0) == 0x80)
 			{
-				SetItem(row, 4, mapObj["falling"].toObject()["command"].toString());
+				--lead;
 			}
-			if (mapObj["falling"].toObject().contains("args") &&
-				mapObj["falling"].toObject()["args"].toArray().size() > 0)
+			unsigned char const c = static_cast<unsigned char>(page[lead]);
+			int const length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+			if (lead + length > page.size())
 			{
-				SetItem(row, 5, mapObj["falling"].toObject()["args"].toArray()[0].toString());
+				page.truncate(lead);
 			}
 		}
-		++row;
+		text = QString::fromUtf8(page);
+	}
+	m_viewOffset += page.size();
+
+	QTextCursor cursor(ui->pteFileView->document());
+	cursor.movePosition(QTextCursor::End);
+	cursor.insertText(text);
+
+	bool const more = m_viewOffset < fileSize;
+	ui->pbLoadMore->setEnabled(more);
+	ui->pbLoadMore->setText(more ? QString("Load More (%1 of %2 KB)").arg(m_viewOffset / 1024).arg(fileSize / 1024) : QString("Load More"));
+}
+
+void MainWindow::CreateStringsList()
+{
+	ui->comboBoxCape->clear();
+
+	for (auto const& file : m_document->files.strings)
+	{
+		ui->comboBoxCape->addItem(QString::fromStdString(file.first));
 	}
 }
 
-void MainWindow::ReadCapeInputsFile(QString const& folder)
+void MainWindow::ShowGPIO()
 {
 	ui->twGPIO->clearContents();
 	ui->twGPIO->setRowCount(0);
 	auto SetItem = [&](int row, int col, QString const& text)
-		{
-			ui->twGPIO->setItem(row, col, new QTableWidgetItem());
-			ui->twGPIO->item(row, col)->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
-			ui->twGPIO->item(row, col)->setText(text);
-		};
+	{
+		ui->twGPIO->setItem(row, col, new QTableWidgetItem());
+		ui->twGPIO->item(row, col)->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+		ui->twGPIO->item(row, col)->setText(text);
+	};
 
-	QFile jsonFile(folder + "/cape-inputs.json");
-	if (!jsonFile.exists())
+	cape_config::cape_files const& files = m_document->files;
+	if (files.gpio)
 	{
-		LogMessage("file not found cape-inputs.json", spdlog::level::level_enum::err);
-		return;
+		ui->twGPIO->setRowCount(static_cast<int>(files.gpio->size()));
+		int row{ 0 };
+
+		for (auto const& mapp : *files.gpio)
+		{
+			SetItem(row, 0, QString::fromStdString(mapp.pin));
+			SetItem(row, 1, QString::fromStdString(mapp.mode));
+			if (!mapp.desc.empty())
+			{
+				SetItem(row, 2, QString::fromStdString(mapp.desc));
+			}
+			if (!mapp.edge.empty())
+			{
+				SetItem(row, 3, QString::fromStdString(mapp.edge));
+				if (!mapp.command.empty())
+				{
+					SetItem(row, 4, QString::fromStdString(mapp.command));
+				}
+				if (!mapp.arg.empty())
+				{
+					SetItem(row, 5, QString::fromStdString(mapp.arg));
+				}
+			}
+			++row;
+		}
 	}
-	if (!jsonFile.open(QIODevice::ReadOnly))
+	else if (files.inputs)
 	{
-		LogMessage("Error Opening: cape-inputs.json", spdlog::level::level_enum::err);
-		return;
-	}
-
-	QByteArray saveData = jsonFile.readAll();
+		//older capes list their inputs in cape-inputs.json instead
+		ui->twGPIO->setRowCount(static_cast<int>(files.inputs->size()));
+		int row{ 0 };
 
-	QJsonDocument loadDoc(QJsonDocument::fromJson(saveData));
-
-	QJsonObject mappingObject = loadDoc.object();
-	QJsonArray mappingArray = mappingObject["inputs"].toArray();
-
-	ui->twGPIO->setRowCount(static_cast<int>(mappingArray.size()));
-	int row{ 0 };
+		for (auto const& mapp : *files.inputs)
+		{
+			SetItem(row, 0, QString::fromStdString(mapp.pin));
+			SetItem(row, 1, QString::fromStdString(mapp.mode));
+			SetItem(row, 3, QString::fromStdString(mapp.edge));
+			SetItem(row, 4, QString::fromStdString(mapp.type));
 
-	for (auto const& mapp : mappingArray)
-	{
-		QJsonObject mapObj = mapp.toObject();
-		QString pin = mapObj["pin"].toString();
-		QString mode = mapObj["mode"].toString();
-		QString edge = mapObj["edge"].toString();
-		QString type = mapObj["type"].toString();
-		SetItem(row, 0, pin);
-		SetItem(row, 1, mode);
-		SetItem(row, 3, edge);
-		SetItem(row, 4, type);
-		
-		++row;
+			++row;
+		}
 	}
 }
 
-void MainWindow::ReadOtherFile(QString const& folder)
+void MainWindow::ShowOther()
 {
 	ui->twOther->clearContents();
 	ui->twOther->setRowCount(0);
-	//C:\Users\scoot\Desktop\BBB16-220513130003-eeprom\tmp\defaults\config\co-other.json
 	auto SetItem = [&](int row, int col, QString const& text)
 	{
 		ui->twOther->setItem(row, col, new QTableWidgetItem());
@@ -358,35 +727,23 @@ void MainWindow::ReadOtherFile(QString const& folder)
 		ui->twOther->item(row, col)->setText(text);
 	};
 
-	QFile jsonFile(folder + "/defaults/config/co-other.json");
-	if (!jsonFile.exists())
-	{
-		LogMessage("file not found co-other.json", spdlog::level::level_enum::err);
-		return;
-	}
-	if (!jsonFile.open(QIODevice::ReadOnly))
+	if (!m_document->files.other)
 	{
-		LogMessage("Error Opening: co-other.json", spdlog::level::level_enum::err);
 		return;
 	}
 
-	QByteArray saveData = jsonFile.readAll();
-	QJsonDocument loadDoc(QJsonDocument::fromJson(saveData));
-	QJsonArray mappingArray = loadDoc.object()["channelOutputs"].toArray();
-
-	ui->twOther->setRowCount(static_cast<int>(mappingArray.size()));
+	ui->twOther->setRowCount(static_cast<int>(m_document->files.other->size()));
 	int row{ 0 };
 
-	for (auto const& mapp : mappingArray)
+	for (auto const& mapp : *m_document->files.other)
 	{
-		QJsonObject mapObj = mapp.toObject();
-		if (mapObj.contains("type"))
+		if (!mapp.type.empty())
 		{
-			SetItem(row, 0, mapObj["type"].toString());
+			SetItem(row, 0, QString::fromStdString(mapp.type));
 		}
-		if (mapObj.contains("device")) 
+		if (!mapp.device.empty())
 		{
-			SetItem(row, 1, mapObj["device"].toString());
+			SetItem(row, 1, QString::fromStdString(mapp.device));
 		}
 		++row;
 	}
@@ -403,70 +760,41 @@ void MainWindow::RedrawStringPortList(QString const& strings)
 		ui->twParts->item(row, col)->setText(text);
 	};
 
-	if (strings.isEmpty() || m_cape.folder.empty())
+	if (strings.isEmpty() || !m_document)
 	{
 		return;
 	}
 
-	QFile jsonFile(QString(m_cape.folder.c_str()) + "/strings/" + strings);
-	if (!jsonFile.exists())
+	auto const& files = m_document->files.strings;
+	std::string const name = strings.toStdString();
+	auto const file = std::find_if(files.begin(), files.end(), [&](auto const& entry) { return entry.first == name; });
+	if (file == files.end())
 	{
 		LogMessage("file not found" + strings, spdlog::level::level_enum::err);
 		return;
 	}
 
-	if (!jsonFile.open(QIODevice::ReadOnly))
-	{
-		LogMessage("Error Opening: " + strings, spdlog::level::level_enum::err);
-		return;
-	}
-
-	QByteArray saveData = jsonFile.readAll();
-	QJsonDocument loadDoc(QJsonDocument::fromJson(saveData));
-	int tableSize{0};
-
-	if (loadDoc.object().contains("outputs"))
-	{
-		tableSize += loadDoc.object()["outputs"].toArray().size();
-	}
-
-	if (loadDoc.object().contains("serial"))
-	{
-		tableSize += loadDoc.object()["serial"].toArray().size();
-	}
-	ui->twParts->setRowCount(tableSize);
+	auto const& rows = file->second;
+	ui->twParts->setRowCount(static_cast<int>(rows.size()));
 	int row{ 0 };
+	int serNum{ 1 };
 
-	if (loadDoc.object().contains("outputs"))
+	for (auto const& mapp : rows)
 	{
-		QJsonArray mappingArray = loadDoc.object()["outputs"].toArray();
-		for (auto const& mapp : mappingArray)
+		if (mapp.serial)
+		{
+			SetItem(row, 0, "Serial " + QString::number(serNum));
+			++serNum;
+		}
+		else
 		{
-			QJsonObject mapObj = mapp.toObject();
 			SetItem(row, 0, "String " + QString::number(row + 1));
-			if (mapObj.contains("pin"))
-			{
-				SetItem(row, 1, mapObj["pin"].toString());
-			}
-			++row;
 		}
-	}
-
-	if (loadDoc.object().contains("serial"))
-	{
-		int serNum{ 1 };
-		QJsonArray mappingArray = loadDoc.object()["serial"].toArray();
-		for (auto const& mapp : mappingArray)
+		if (!mapp.pin.empty())
 		{
-			QJsonObject mapObj = mapp.toObject();
-			SetItem(row, 0, "Serial " + QString::number(serNum));
-			if (mapObj.contains("pin"))
-			{
-				SetItem(row, 1, mapObj["pin"].toString());
-			}
-			++row;
-			++serNum;
+			SetItem(row, 1, QString::fromStdString(mapp.pin));
 		}
+		++row;
 	}
 }
 
@@ -487,14 +815,36 @@ void MainWindow::AddRecentList(QString const& file)
 
 void MainWindow::RedrawRecentList()
 {
-	ui->menuRecent->clear();
-	auto recentProjectList = settings->value("Recent_ProjectsList").toStringList();
-	for (auto const& file : recentProjectList)
+	auto const recentProjectList = settings->value("Recent_ProjectsList").toStringList();
+	int const generation = ++m_recentGeneration;
+
+	//checking each file can stall on network drives, do it off the UI thread
+	QPointer<MainWindow> self(this);
+	QThreadPool::globalInstance()->start(QRunnable::create([self, recentProjectList, generation]()
 	{
-		if (!QFile::exists(file))
+		QStringList existing;
+		for (auto const& file : recentProjectList)
 		{
-			continue;
+			if (QFile::exists(file))
+			{
+				existing.append(file);
+			}
 		}
+		QMetaObject::invokeMethod(qApp, [self, existing, generation]()
+		{
+			if (self && self->m_recentGeneration == generation)
+			{
+				self->ShowRecentList(existing);
+			}
+		}, Qt::QueuedConnection);
+	}));
+}
+
+void MainWindow::ShowRecentList(QStringList const& recentProjectList)
+{
+	ui->menuRecent->clear();
+	for (auto const& file : recentProjectList)
+	{
 		QFileInfo fileInfo(file);
 		auto* recentpn = new QAction(this);
 		recentpn->setText(fileInfo.dir().dirName() + "/" + fileInfo.fileName());
@@ -509,6 +859,10 @@ void MainWindow::RedrawRecentList()
 
 void MainWindow::LogMessage(QString const& message, spdlog::level::level_enum llvl)
 {
+	if (!logger)
+	{
+		return;
+	}
 	logger->log(llvl, message.toStdString());
 }
 
@@ -539,16 +893,11 @@ QMap<QString, QString> MainWindow::GetVendorURLList() const
 	auto content = response->readAll();
 	response->deleteLater();
 
-	QJsonDocument loadDoc(QJsonDocument::fromJson(content));
-	QJsonObject mainObject = loadDoc.object();
-
-	QJsonObject capeVendor = mainObject["vendors"].toObject();
 	QMap<QString, QString> vendorList;
 
-	for (auto const & vendorKey: capeVendor.keys()) 
+	for (auto const& [vendor, vendorURL] : cape_config::read_vendors(std::string_view(content.constData(), content.size())))
 	{
-		QString vendorURL = capeVendor.value(vendorKey)["url"].toString();
-		vendorList.insert(vendorKey, vendorURL);
+		vendorList.insert(QString::fromStdString(vendor), QString::fromStdString(vendorURL));
 	}
 	return vendorList;
 }
@@ -576,22 +925,11 @@ QMap<QString, QString> MainWindow::GetFirmwareURLList(QString const& url) const
 	auto content = response->readAll();
 	response->deleteLater();
 
-	QJsonDocument loadDoc(QJsonDocument::fromJson(content));
-
 	QMap<QString, QString> capeList;
 
-	QJsonObject mainObject = loadDoc.object();
-
-	QJsonObject capeObject = mainObject["capes"].toObject();
-
-	for (auto const& capeKey : capeObject.keys())
+	for (auto const& [cape, eepromURL] : cape_config::read_firmware(std::string_view(content.constData(), content.size())))
 	{
-		QJsonObject versions = capeObject.value(capeKey)["versions"].toObject();
-		for (auto const& verKey : versions.keys())
-		{
-			QString eepromURL = versions.value(verKey)["url"].toString();
-			capeList.insert(capeKey + "_" + verKey, eepromURL);
-		}
+		capeList.insert(QString::fromStdString(cape), QString::fromStdString(eepromURL));
 	}
 
 	return capeList;
@@ -2,7 +2,12 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
 
+#include "cape_config.h"
 #include "cape_info.h"
 
 #include "spdlog/spdlog.h"
@@ -18,8 +23,21 @@ class QListWidgetItem;
 class QListWidget;
 class QTableWidget;
 class QSettings;
+class QTabBar;
+class QFileSystemModel;
+class QModelIndex;
+class QDragEnterEvent;
+class QDropEvent;
+class QShowEvent;
 QT_END_NAMESPACE
 
+// An open image and its config files, decoded once when it is loaded
+struct cape_document
+{
+    cape_info cape;
+    cape_config::cape_files files;
+};
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -28,6 +46,9 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    void OpenEEPROMs(QStringList const& files);
+    void SetStartupTimer(QElapsedTimer const& timer);
+
 public Q_SLOTS:
 
     void on_actionOpen_EEPROM_triggered();
@@ -41,29 +62,64 @@ public Q_SLOTS:
     void on_menuRecent_triggered();
     void on_actionClear_triggered();
 
+    void on_pbLoadMore_clicked();
+
     void RedrawStringPortList(QString const& string);
 
     void LogMessage(QString const& message , spdlog::level::level_enum llvl = spdlog::level::level_enum::debug);
 
+protected:
+    void dragEnterEvent(QDragEnterEvent* event) override;
+    void dropEvent(QDropEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
 private:
     Ui::MainWindow *ui;
 
     std::shared_ptr<spdlog::logger> logger{ nullptr };
     std::unique_ptr<QSettings> settings{ nullptr };
     QString appdir;
-
-    cape_info m_cape;
-
-    void ReadCapeInfo(QString const& file);
-    void CreateStringsList(QString const& folder);
-    void ReadGPIOFile(QString const& folder);
-    void ReadCapeInputsFile(QString const& folder);
-    void ReadOtherFile(QString const& folder);
+    QElapsedTimer m_startupTimer;
+    qint64 m_shownMs{ -1 };
+    qint64 m_readyMs{ -1 };
+    int m_recentGeneration{ 0 };
+
+    std::shared_ptr<cape_document const> m_document;
+    QMap<QString, std::shared_ptr<cape_document const>> m_capes;
+    QSet<QString> m_loading;
+    QStringList m_pendingFiles;
+    QTabBar* m_documentTabs{ nullptr };
+
+    QMap<QString, QFileSystemModel*> m_fileModels;
+    QFileSystemModel* m_fileModel{ nullptr };
+    QString m_viewPath;
+    qint64 m_viewOffset{ 0 };
+    bool m_viewBinary{ false };
+
+    void ShowCapeInfo();
+    void CreateStringsList();
+    void ShowGPIO();
+    void ShowOther();
+    void SetFileModel(QFileSystemModel* model);
+    void ShowFileTree(QString const& filepath);
+    void OnFileActivated(QModelIndex const& index);
+    void OpenFileView(QString const& path);
+    void LoadFilePage();
 
     void AddRecentList(QString const& project);
     void RedrawRecentList();
+    void ShowRecentList(QStringList const& recentProjectList);
+    void FinishStartup();
+    void ReportStartup();
 
     void LoadEEPROM(QString const& filepath);
+    void OnEEPROMLoaded(QString const& filepath, std::shared_ptr<cape_document const> const& document);
+    void ShowDocument(int index);
+    void CloseDocument(int index);
+    void ReleaseDocument(QString const& filepath);
+    int FindDocument(QString const& filepath) const;
+    QString ExtractionOwner(QString const& filepath) const;
     QMap<QString, QString> GetVendorURLList() const;
     QMap<QString, QString> GetFirmwareURLList(QString const& url) const;
     void DownloadFirmware(QString const& name, QString const& url);
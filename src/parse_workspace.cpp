@@ -0,0 +1,28 @@
+#include "parse_workspace.h"
+#include "fpp_layout.h"
+
+parse_workspace::parse_workspace()
+    : m_arena(m_inline.data(), m_inline.size(), &m_upstream)
+{
+    m_image.reserve(fpp_layout::max_image_size);
+}
+
+void parse_workspace::reset()
+{
+    m_image.clear();
+    // the table lives in the arena, drop its storage before the arena is rewound
+    std::pmr::vector<eeprom_section>(&m_arena).swap(m_sections);
+    m_arena.release();
+    m_upstream.allocations = 0;
+}
+
+void* parse_workspace::counting_resource::do_allocate(std::size_t bytes, std::size_t align)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+}
+
+void parse_workspace::counting_resource::do_deallocate(void* p, std::size_t bytes, std::size_t align)
+{
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+}
@@ -0,0 +1,57 @@
+#ifndef PARSE_WORKSPACE_H
+#define PARSE_WORKSPACE_H
+
+#include "section_handlers.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// Scratch memory for parseEEPROM that is kept between images.
+// Holds the image buffer and a monotonic arena for the section tables. reset() rewinds the
+// arena to its inline buffer, so as long as the tables fit, parsing image after image allocates nothing.
+// The section table of the last image stays readable through sections() until the next reset().
+// Not thread safe, use one workspace per thread.
+class parse_workspace
+{
+public:
+	parse_workspace();
+
+	parse_workspace(parse_workspace const&) = delete;
+	parse_workspace& operator=(parse_workspace const&) = delete;
+
+	std::vector<uint8_t>& image() { return m_image; }
+	std::pmr::memory_resource* resource() { return &m_arena; }
+	// names and payloads point into image()
+	std::pmr::vector<eeprom_section>& sections() { return m_sections; }
+
+	void reset();
+
+	// times the arena outgrew its inline buffer and had to go to the heap while parsing the current image
+	std::size_t spills() const { return m_upstream.allocations.load(std::memory_order_relaxed); }
+
+private:
+	// counts heap allocations made on behalf of the arena
+	class counting_resource : public std::pmr::memory_resource
+	{
+	public:
+		// atomic so a spill counted while spills() is read elsewhere is no data race
+		std::atomic<std::size_t> allocations{ 0 };
+
+	private:
+		void* do_allocate(std::size_t bytes, std::size_t align) override;
+		void do_deallocate(void* p, std::size_t bytes, std::size_t align) override;
+		bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override { return this == &other; }
+	};
+
+	std::vector<uint8_t> m_image;
+	alignas(std::max_align_t) std::array<std::byte, 8192> m_inline{};
+	counting_resource m_upstream;
+	std::pmr::monotonic_buffer_resource m_arena;
+	std::pmr::vector<eeprom_section> m_sections{ &m_arena };
+};
+
+#endif // PARSE_WORKSPACE_H
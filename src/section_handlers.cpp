@@ -0,0 +1,230 @@
+#include "section_handlers.h"
+#include "cape_utils.h"
+#include "eeprom_reader.h"
+
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+
+namespace
+{
+    bool same_component(std::string_view a, std::string_view b)
+    {
+        // the extraction folder may be on a case insensitive file system
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+
+    // the path a section writes, or the folder its archive unpacks into, relative to the extraction folder.
+    // Paths that climb out are rejected by section_path() before anything is written, so they are not checked here.
+    std::string_view write_target(std::string_view name, bool unpacks)
+    {
+        if (!unpacks) {
+            return name;
+        }
+        std::size_t const slash = name.find_last_of("/\\");
+        return slash == std::string_view::npos ? std::string_view() : name.substr(0, slash);
+    }
+
+    // true when one target lies inside the other, or both are the same
+    bool overlaps(std::string_view a, std::string_view b)
+    {
+        std::string_view partA;
+        std::string_view partB;
+        while (true) {
+            bool const moreA = cape_utils::next_component(a, partA);
+            bool const moreB = cape_utils::next_component(b, partB);
+            if (!moreA || !moreB) {
+                return true;
+            }
+            if (!same_component(partA, partB)) {
+                return false;
+            }
+        }
+    }
+}
+
+file_section_handler::file_section_handler(QString tool, QStringList args)
+    : m_tool(std::move(tool))
+    , m_args(std::move(args))
+{
+}
+
+unsigned file_section_handler::capabilities() const
+{
+    return writes_files | independent | (m_tool.isEmpty() ? capability_none : runs_tool);
+}
+
+void file_section_handler::decode(eeprom_section const& section, std::string const& eepromdir, section_result& result) const
+{
+    auto const target = cape_utils::section_path(eepromdir, section.name);
+    if (!target) {
+        result.error = "unsafe section path at offset " + std::to_string(section.offset);
+        return;
+    }
+    try
+    {
+        std::string const path = target->string();
+        // the path was checked to end in a file name, so everything before the last separator is its folder
+        std::size_t const slash = path.find_last_of("/\\");
+        std::string_view const dir = slash == std::string::npos ? std::string_view() : std::string_view(path).substr(0, slash);
+        std::filesystem::create_directories(target->parent_path());
+        // check again now the folders exist, nothing may resolve outside the extraction folder
+        if (!cape_utils::is_within(eepromdir, *target)) {
+            result.error = "unsafe section path at offset " + std::to_string(section.offset);
+            return;
+        }
+        result.folder = dir;
+        if (!cape_utils::put_file_contents(path, section.data, static_cast<int>(section.size))) {
+            result.error = "failed to write section " + path;
+            return;
+        }
+        if (!m_tool.isEmpty()) {
+            cape_utils::exec(m_tool, QStringList(m_args) << path.c_str(), QString::fromUtf8(dir.data(), static_cast<int>(dir.size())));
+        }
+    }
+    catch (std::exception const& ex)
+    {
+        result.error = ex.what();
+    }
+}
+
+void serial_section_handler::decode(eeprom_section const& section, std::string const&, section_result& result) const
+{
+    std::string_view const serial(reinterpret_cast<const char*>(section.data), 16);
+    result.serialNumber.emplace(eeprom_reader::trim(serial), result.get_allocator());
+}
+
+section_registry& section_registry::defaults()
+{
+    static section_registry registry;
+    // runs once, before the first caller gets the registry
+    [[maybe_unused]] static bool const registered = []() {
+        registry.add(0, std::make_shared<file_section_handler>());
+        registry.add(1, std::make_shared<file_section_handler>("unzip", QStringList() << "-x"));
+        registry.add(2, std::make_shared<file_section_handler>("tar", QStringList() << "-xzvf"));
+        registry.add(3, std::make_shared<file_section_handler>("tar", QStringList() << "-xzvf"));
+        registry.add(96, std::make_shared<serial_section_handler>());
+        registry.add(98, std::make_shared<fixed_section_handler>(2));
+        return true;
+    }();
+    return registry;
+}
+
+void section_registry::add(int flag, std::shared_ptr<section_handler const> handler)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_handlers[flag] = std::move(handler);
+}
+
+std::shared_ptr<section_handler const> section_registry::find(int flag) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    auto const it = m_handlers.find(flag);
+    return it == m_handlers.end() ? nullptr : it->second;
+}
+
+std::pmr::vector<section_result> section_registry::decode(std::span<eeprom_section const> sections, std::string const& eepromdir,
+    std::pmr::memory_resource* resource) const
+{
+    std::pmr::vector<section_result> results(sections.size(), resource);
+
+    // where each section writes, a file path or the folder an archive unpacks into
+    std::pmr::vector<std::string_view> targets(sections.size(), resource);
+    std::pmr::vector<bool> writes(sections.size(), false, resource);
+    for (std::size_t i = 0; i < sections.size(); ++i) {
+        unsigned const caps = sections[i].handler ? sections[i].handler->capabilities() : capability_none;
+        if (caps & (writes_files | runs_tool)) {
+            writes[i] = true;
+            targets[i] = write_target(sections[i].name, (caps & runs_tool) != 0);
+        }
+    }
+
+    // sections whose targets overlap keep their image order, what ends up on disk must not depend on timing
+    std::pmr::vector<bool> ordered(sections.size(), false, resource);
+    for (std::size_t i = 0; i < sections.size(); ++i) {
+        for (std::size_t j = i + 1; j < sections.size() && writes[i]; ++j) {
+            if (writes[j] && overlaps(targets[i], targets[j])) {
+                ordered[i] = true;
+                ordered[j] = true;
+            }
+        }
+    }
+
+    bool const threads = m_parallel;
+    std::pmr::vector<std::size_t> parallel(resource);
+    std::pmr::vector<std::size_t> serial(resource);
+    for (std::size_t i = 0; i < sections.size(); ++i) {
+        if (sections[i].handler == nullptr) {
+            continue;
+        }
+        // only sections that spawn a tool or touch the disk are worth a thread
+        bool const worth_thread = threads && writes[i] && !ordered[i] && (sections[i].handler->capabilities() & independent);
+        (worth_thread ? parallel : serial).push_back(i);
+    }
+
+    auto decode_one = [&](std::size_t i, section_result& result) {
+        try
+        {
+            sections[i].handler->decode(sections[i], eepromdir, result);
+        }
+        catch (std::exception const& ex)
+        {
+            result.error = ex.what();
+        }
+    };
+
+    // resource may be a parse arena, which is not thread safe. Sections decoded on helper threads
+    // fill results on the default resource instead, they are copied into place after the join.
+    std::vector<section_result> detached(parallel.size());
+    std::atomic<std::size_t> next{ 0 };
+    auto drain = [&]() {
+        for (std::size_t n = next++; n < parallel.size(); n = next++) {
+            decode_one(parallel[n], detached[n]);
+        }
+    };
+
+    // images are usually parsed on the global pool already, borrow its idle threads instead of starting more.
+    // tryStart never queues, so this cannot wait on work stuck behind other parses; the calling thread drains what is left.
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::size_t helpers{ 0 };
+    for (std::size_t h = 1; h < parallel.size(); ++h) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++helpers;
+        }
+        bool const started = QThreadPool::globalInstance()->tryStart([&]() {
+            drain();
+            std::lock_guard<std::mutex> lock(mutex);
+            --helpers;
+            finished.notify_all();
+        });
+        if (!started) {
+            std::lock_guard<std::mutex> lock(mutex);
+            --helpers;
+            break;
+        }
+    }
+
+    for (std::size_t i : serial) {
+        decode_one(i, results[i]);
+    }
+    drain();
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&]() { return helpers == 0; });
+    }
+    for (std::size_t n = 0; n < parallel.size(); ++n) {
+        section_result& result = results[parallel[n]];
+        result = section_result(std::move(detached[n]), result.get_allocator());
+    }
+    return results;
+}
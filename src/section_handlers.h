@@ -0,0 +1,158 @@
+#ifndef SECTION_HANDLERS_H
+#define SECTION_HANDLERS_H
+
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class section_handler;
+
+// One section of an FPP02 image, pointing into the loaded image.
+struct eeprom_section
+{
+	int flag{ 0 };
+	std::size_t offset{ 0 };   // start of the section header in the image
+	std::string_view name;     // path field, empty for flags without one
+	std::size_t payload_offset{ 0 };
+	const uint8_t* data{ nullptr };   // payload, null until it has been read
+	std::size_t size{ 0 };
+	// the handler found while scanning, kept so a later add() cannot change it halfway through a parse.
+	// Null for flags nobody handles, those are listed but never decoded.
+	std::shared_ptr<section_handler const> handler;
+};
+
+// What a handler contributes to the cape_info, merged in section order.
+// Allocator aware, so results decoded into the parse arena keep their strings there too.
+struct section_result
+{
+	using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+	section_result() = default;
+	explicit section_result(allocator_type alloc) : folder(alloc), error(alloc) {}
+	section_result(section_result const& other, allocator_type alloc)
+		: folder(other.folder, alloc), error(other.error, alloc)
+	{
+		if (other.serialNumber) {
+			serialNumber.emplace(*other.serialNumber, alloc);
+		}
+	}
+	section_result(section_result&& other, allocator_type alloc)
+		: folder(std::move(other.folder), alloc), error(std::move(other.error), alloc)
+	{
+		if (other.serialNumber) {
+			serialNumber.emplace(std::move(*other.serialNumber), alloc);
+		}
+	}
+	section_result(section_result const&) = default;
+	section_result(section_result&&) = default;
+	section_result& operator=(section_result const&) = default;
+	section_result& operator=(section_result&&) = default;
+
+	allocator_type get_allocator() const { return folder.get_allocator(); }
+
+	std::pmr::string folder;
+	std::optional<std::pmr::string> serialNumber;
+	std::pmr::string error;
+};
+
+enum section_capability : unsigned
+{
+	capability_none = 0,
+	writes_files = 1 << 0,   // writes below the extraction folder
+	runs_tool = 1 << 1,      // spawns an external unpacker
+	updates_info = 1 << 2,   // fills cape_info fields
+	independent = 1 << 3,    // may be decoded concurrently with other sections
+};
+
+class section_handler
+{
+public:
+	virtual ~section_handler() = default;
+
+	virtual unsigned capabilities() const = 0;
+
+	// bytes of payload following the section header, most sections use the length field
+	virtual std::size_t payload_size(std::size_t length) const { return length; }
+
+	virtual void decode(eeprom_section const& section, std::string const& eepromdir, section_result& result) const = 0;
+};
+
+// Writes the section payload to its path, then optionally unpacks it with an external tool.
+class file_section_handler : public section_handler
+{
+public:
+	file_section_handler() = default;
+	file_section_handler(QString tool, QStringList args);
+
+	unsigned capabilities() const override;
+	void decode(eeprom_section const& section, std::string const& eepromdir, section_result& result) const override;
+
+private:
+	QString m_tool;
+	QStringList m_args;
+};
+
+// Flag 96, a 16 byte serial number followed by 42 reserved bytes.
+class serial_section_handler : public section_handler
+{
+public:
+	unsigned capabilities() const override { return updates_info | independent; }
+	std::size_t payload_size(std::size_t) const override { return 58; }
+	void decode(eeprom_section const& section, std::string const& eepromdir, section_result& result) const override;
+};
+
+// Consumes a fixed number of bytes regardless of the length field.
+class fixed_section_handler : public section_handler
+{
+public:
+	explicit fixed_section_handler(std::size_t size) : m_size(size) {}
+
+	unsigned capabilities() const override { return independent; }
+	std::size_t payload_size(std::size_t) const override { return m_size; }
+	void decode(eeprom_section const&, std::string const&, section_result&) const override {}
+
+private:
+	std::size_t m_size;
+};
+
+// Maps section flags to handlers. Unknown flags are skipped using their length field.
+// add() and find() may be called from any thread, so handlers can be plugged in while images are parsed.
+class section_registry
+{
+public:
+	static section_registry& defaults();
+
+	void add(int flag, std::shared_ptr<section_handler const> handler);
+	std::shared_ptr<section_handler const> find(int flag) const;
+
+	// with parallel decoding off every section is decoded in image order on the calling thread,
+	// the benchmark uses it to compare both
+	void set_parallel(bool parallel) { m_parallel = parallel; }
+	bool parallel() const { return m_parallel; }
+
+	// Sections that write files or run a tool are decoded on idle threads of the global thread pool,
+	// unless another section writes to the same path or unpacks over it. Those, and everything else,
+	// are decoded in image order on the calling thread. Results line up with sections, so merging them stays deterministic.
+	// Only the calling thread allocates from resource, it does not have to be thread safe.
+	std::pmr::vector<section_result> decode(std::span<eeprom_section const> sections, std::string const& eepromdir,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+private:
+	mutable std::shared_mutex m_mutex;
+	std::map<int, std::shared_ptr<section_handler const>> m_handlers;
+	std::atomic<bool> m_parallel{ true };
+};
+
+#endif // SECTION_HANDLERS_H
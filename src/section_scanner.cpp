@@ -0,0 +1,58 @@
+#include "section_scanner.h"
+#include "eeprom_reader.h"
+#include "fpp_layout.h"
+
+#include <algorithm>
+
+std::span<const uint8_t> memory_section_source::read(std::size_t offset, std::size_t len)
+{
+    if (offset >= m_image.size()) {
+        return {};
+    }
+    return m_image.subspan(offset, std::min(len, m_image.size() - offset));
+}
+
+std::string scan_sections(section_source& source, section_registry const& registry, std::pmr::vector<eeprom_section>& sections)
+{
+    auto diagnostic = [](eeprom_reader const& reader, std::size_t offset) {
+        return std::string(reader.error()) + " at offset " + std::to_string(offset + reader.error_offset());
+    };
+
+    std::size_t offset = fpp_layout::header_size;
+    while (offset < source.size()) {
+        // one read covers the length, flag and path fields
+        auto const head = source.read(offset, fpp_layout::section_path.end());
+        eeprom_reader reader(head.data(), head.size());
+        if (reader.at_padding(fpp_layout::section_length.length)) {
+            break;
+        }
+        auto const flen = reader.number(fpp_layout::section_length.length);
+        auto const flag = reader.number(fpp_layout::section_flag.length);
+        if (!flen || !flag) {
+            return diagnostic(reader, offset);
+        }
+        if (*flen == 0) {
+            break;
+        }
+
+        eeprom_section section;
+        section.flag = *flag;
+        section.offset = offset;
+        if (*flag < fpp_layout::path_flag_limit) {
+            auto const file_path = reader.text(fpp_layout::section_path.length);
+            if (!file_path) {
+                return diagnostic(reader, offset);
+            }
+            section.name = *file_path;
+        }
+        section.handler = registry.find(*flag);
+        section.payload_offset = offset + reader.offset();
+        section.size = section.handler ? section.handler->payload_size(*flen) : static_cast<std::size_t>(*flen);
+        if (section.payload_offset > source.size() || section.size > source.size() - section.payload_offset) {
+            return "data runs past end of image at offset " + std::to_string(section.payload_offset);
+        }
+        offset = section.payload_offset + section.size;
+        sections.push_back(std::move(section));
+    }
+    return {};
+}
@@ -0,0 +1,41 @@
+#ifndef SECTION_SCANNER_H
+#define SECTION_SCANNER_H
+
+#include "section_handlers.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <string>
+
+// Where the section scanner reads from, an image in memory or the EEPROM device itself.
+class section_source
+{
+public:
+	virtual ~section_source() = default;
+
+	virtual std::size_t size() const = 0;
+	// up to len bytes at offset, they have to stay valid for as long as the source does
+	virtual std::span<const uint8_t> read(std::size_t offset, std::size_t len) = 0;
+};
+
+class memory_section_source : public section_source
+{
+public:
+	explicit memory_section_source(std::span<const uint8_t> image) : m_image(image) {}
+
+	std::size_t size() const override { return m_image.size(); }
+	std::span<const uint8_t> read(std::size_t offset, std::size_t len) override;
+
+private:
+	std::span<const uint8_t> m_image;
+};
+
+// Walks the section table after the FPP02 header and appends every section, those without a
+// handler too (handler left null), so inventories see the whole table. Decoding skips them.
+// Only the section headers are read, payloads are skipped and data is left null.
+// Returns a diagnostic when the table is malformed, the sections before the fault are kept.
+std::string scan_sections(section_source& source, section_registry const& registry, std::pmr::vector<eeprom_section>& sections);
+
+#endif // SECTION_SCANNER_H
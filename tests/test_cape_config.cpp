@@ -0,0 +1,348 @@
+// cape_config readers against the QJsonDocument code they replaced, on config files shaped like
+// the ones FPP ships. Every fixture in the table is read both ways and the rows must match.
+
+#include "test_common.h"
+
+#include "cape_config.h"
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cape_config
+{
+    bool operator==(gpio_row const& a, gpio_row const& b)
+    {
+        return a.pin == b.pin && a.mode == b.mode && a.desc == b.desc && a.edge == b.edge && a.command == b.command &&
+            a.arg == b.arg && a.type == b.type;
+    }
+
+    bool operator==(other_row const& a, other_row const& b)
+    {
+        return a.type == b.type && a.device == b.device;
+    }
+
+    bool operator==(string_port_row const& a, string_port_row const& b)
+    {
+        return a.serial == b.serial && a.pin == b.pin;
+    }
+
+    std::ostream& operator<<(std::ostream& out, gpio_row const& r)
+    {
+        return out << r.pin << '|' << r.mode << '|' << r.desc << '|' << r.edge << '|' << r.command << '|' << r.arg << '|' << r.type;
+    }
+
+    std::ostream& operator<<(std::ostream& out, other_row const& r)
+    {
+        return out << r.type << '|' << r.device;
+    }
+
+    std::ostream& operator<<(std::ostream& out, string_port_row const& r)
+    {
+        return out << (r.serial ? "serial" : "output") << '|' << r.pin;
+    }
+
+    template <typename Row>
+    std::ostream& operator<<(std::ostream& out, std::vector<Row> const& rows)
+    {
+        out << rows.size() << " rows";
+        for (auto const& row : rows) {
+            out << "\n  " << row;
+        }
+        return out;
+    }
+}
+
+namespace
+{
+    using cape_config::gpio_row;
+    using cape_config::other_row;
+    using cape_config::string_port_row;
+
+    // name to url, printable in failure messages
+    struct url_map : std::map<std::string, std::string>
+    {
+    };
+
+    std::ostream& operator<<(std::ostream& out, url_map const& urls)
+    {
+        out << urls.size() << " urls";
+        for (auto const& [name, url] : urls) {
+            out << "\n  " << name << " -> " << url;
+        }
+        return out;
+    }
+
+    std::string read_file(std::string const& name)
+    {
+        std::ifstream in(std::string(CAPE_TEST_DATA) + "/" + name, std::ios::binary);
+        CHECK(in.good());
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    QJsonDocument document(std::string const& text)
+    {
+        return QJsonDocument::fromJson(QByteArray(text.data(), static_cast<int>(text.size())));
+    }
+
+    std::string text(QJsonValue const& value)
+    {
+        return value.toString().toStdString();
+    }
+
+    // the QJsonDocument readers, as MainWindow had them
+
+    void reference_edge(gpio_row& row, QJsonObject const& edge)
+    {
+        if (edge.contains("command")) {
+            row.command = text(edge["command"]);
+        }
+        if (edge.contains("args") && edge["args"].toArray().size() > 0) {
+            row.arg = text(edge["args"].toArray()[0]);
+        }
+    }
+
+    std::vector<gpio_row> reference_gpio(std::string const& json)
+    {
+        std::vector<gpio_row> rows;
+        for (auto const& mapp : document(json).array()) {
+            QJsonObject mapObj = mapp.toObject();
+            gpio_row row;
+            row.pin = text(mapObj["pin"]);
+            row.mode = text(mapObj["mode"]);
+            if (mapObj.contains("desc")) {
+                row.desc = text(mapObj["desc"]);
+            }
+            if (mapObj.contains("rising")) {
+                row.edge = "rising";
+                reference_edge(row, mapObj["rising"].toObject());
+            }
+            else if (mapObj.contains("falling")) {
+                row.edge = "falling";
+                reference_edge(row, mapObj["falling"].toObject());
+            }
+            rows.push_back(row);
+        }
+        return rows;
+    }
+
+    std::vector<gpio_row> reference_inputs(std::string const& json)
+    {
+        std::vector<gpio_row> rows;
+        for (auto const& mapp : document(json).object()["inputs"].toArray()) {
+            QJsonObject mapObj = mapp.toObject();
+            gpio_row row;
+            row.pin = text(mapObj["pin"]);
+            row.mode = text(mapObj["mode"]);
+            row.edge = text(mapObj["edge"]);
+            row.type = text(mapObj["type"]);
+            rows.push_back(row);
+        }
+        return rows;
+    }
+
+    std::vector<other_row> reference_other(std::string const& json)
+    {
+        std::vector<other_row> rows;
+        for (auto const& mapp : document(json).object()["channelOutputs"].toArray()) {
+            QJsonObject mapObj = mapp.toObject();
+            other_row row;
+            if (mapObj.contains("type")) {
+                row.type = text(mapObj["type"]);
+            }
+            if (mapObj.contains("device")) {
+                row.device = text(mapObj["device"]);
+            }
+            rows.push_back(row);
+        }
+        return rows;
+    }
+
+    std::vector<string_port_row> reference_string_ports(std::string const& json)
+    {
+        std::vector<string_port_row> rows;
+        QJsonObject const root = document(json).object();
+        for (char const* member : { "outputs", "serial" }) {
+            if (!root.contains(member)) {
+                continue;
+            }
+            for (auto const& mapp : root[member].toArray()) {
+                QJsonObject mapObj = mapp.toObject();
+                string_port_row row;
+                row.serial = std::string(member) == "serial";
+                if (mapObj.contains("pin")) {
+                    row.pin = text(mapObj["pin"]);
+                }
+                rows.push_back(row);
+            }
+        }
+        return rows;
+    }
+
+    url_map reference_vendors(std::string const& json)
+    {
+        url_map vendors;
+        QJsonObject const capeVendor = document(json).object()["vendors"].toObject();
+        for (auto const& vendorKey : capeVendor.keys()) {
+            vendors[vendorKey.toStdString()] = text(capeVendor.value(vendorKey).toObject()["url"]);
+        }
+        return vendors;
+    }
+
+    url_map reference_firmware(std::string const& json)
+    {
+        url_map capes;
+        QJsonObject const capeObject = document(json).object()["capes"].toObject();
+        for (auto const& capeKey : capeObject.keys()) {
+            QJsonObject const versions = capeObject.value(capeKey).toObject()["versions"].toObject();
+            for (auto const& verKey : versions.keys()) {
+                capes[(capeKey + "_" + verKey).toStdString()] = text(versions.value(verKey).toObject()["url"]);
+            }
+        }
+        return capes;
+    }
+
+    // MainWindow puts the url lists into a QMap, so later duplicates win and order does not matter
+    url_map as_map(cape_config::url_list const& urls)
+    {
+        url_map map;
+        for (auto const& [name, url] : urls) {
+            map[name] = url;
+        }
+        return map;
+    }
+
+    enum class reader { gpio, inputs, other, string_ports, vendors, firmware };
+
+    struct fixture
+    {
+        char const* name;
+        reader kind;
+        std::size_t rows;   // expected row count, guards against both sides reading nothing
+    };
+
+    void compare(std::string const& label, std::string const& json, reader kind, std::size_t rows)
+    {
+        int const before = test::failures;
+        switch (kind) {
+        case reader::gpio:
+            CHECK_EQ(cape_config::read_gpio(json), reference_gpio(json));
+            CHECK_EQ(cape_config::read_gpio(json).size(), rows);
+            break;
+        case reader::inputs:
+            CHECK_EQ(cape_config::read_inputs(json), reference_inputs(json));
+            CHECK_EQ(cape_config::read_inputs(json).size(), rows);
+            break;
+        case reader::other:
+            CHECK_EQ(cape_config::read_other(json), reference_other(json));
+            CHECK_EQ(cape_config::read_other(json).size(), rows);
+            break;
+        case reader::string_ports:
+            CHECK_EQ(cape_config::read_string_ports(json), reference_string_ports(json));
+            CHECK_EQ(cape_config::read_string_ports(json).size(), rows);
+            break;
+        case reader::vendors:
+            CHECK_EQ(as_map(cape_config::read_vendors(json)), reference_vendors(json));
+            CHECK_EQ(as_map(cape_config::read_vendors(json)).size(), rows);
+            break;
+        case reader::firmware:
+            CHECK_EQ(as_map(cape_config::read_firmware(json)), reference_firmware(json));
+            CHECK_EQ(as_map(cape_config::read_firmware(json)).size(), rows);
+            break;
+        }
+        if (test::failures != before) {
+            std::fprintf(stderr, "  in %s\n", label.c_str());
+        }
+    }
+
+    void test_fixtures()
+    {
+        fixture const fixtures[] = {
+            { "gpio.json", reader::gpio, 6 },
+            { "gpio-escaped.json", reader::gpio, 1 },
+            { "cape-inputs.json", reader::inputs, 3 },
+            { "co-other.json", reader::other, 3 },
+            { "strings/F16-B.json", reader::string_ports, 6 },
+            { "strings/serial-first.json", reader::string_ports, 4 },
+            { "eepromVendors.json", reader::vendors, 3 },
+            { "escaped.json", reader::vendors, 4 },
+            { "catalog.json", reader::firmware, 3 },
+            { "truncated.json", reader::gpio, 0 },
+        };
+        for (auto const& f : fixtures) {
+            compare(f.name, read_file(f.name), f.kind, f.rows);
+        }
+    }
+
+    void test_inline()
+    {
+        struct inline_case
+        {
+            char const* json;
+            reader kind;
+            std::size_t rows;
+        };
+        inline_case const cases[] = {
+            { "[]", reader::gpio, 0 },
+            { "", reader::gpio, 0 },
+            { "[{\"pin\":\"P8-07\"}", reader::gpio, 0 },
+            { "[{\"pin\":\"P8-07\"},", reader::gpio, 0 },
+            { "[{\"pin\":\"P8-07\"},]", reader::gpio, 0 },
+            { "[{\"pin\":\"P8-07\"}] trailing", reader::gpio, 0 },
+            { "[{\"pin\":\"a\"} {\"pin\":\"b\"}]", reader::gpio, 0 },
+            { "[,{\"pin\":\"a\"}]", reader::gpio, 0 },
+            { "[{\"pin\":\"a\"},,{\"pin\":\"b\"}]", reader::gpio, 0 },
+            { "[{\"pin\":\"a\",\"x\":garbage}]", reader::gpio, 0 },
+            { "[{\"pin\":\"a\",\"x\":[1,true,null,-2.5e3]}]", reader::gpio, 1 },
+            { "{\"x\":garbage,\"inputs\":[{\"pin\":\"a\"}]}", reader::inputs, 0 },
+            { "[{\"pin\":\"P8-07\",\"pin\":\"P8-08\"}]", reader::gpio, 1 },
+            { "{\"inputs\":{}}", reader::inputs, 0 },
+            { "[{\"pin\":\"P8-07\"}]", reader::inputs, 0 },
+            { "{\"channelOutputs\":[{\"type\":\"GenericSPI\",\"device\":\"spidev1.0\"}", reader::other, 0 },
+            { "{\"outputs\":[{\"pin\":\"P8-43\"}],\"serial\":[{\"pin\":\"P9-24\"}", reader::string_ports, 0 },
+            { "{\"vendors\":{\"A\":{\"url\":\"a\"},\"A\":{\"url\":\"b\"}}}", reader::vendors, 1 },
+            { "{\"vendors\":{\"A\":{\"url\":\"a\"}", reader::vendors, 0 },
+            { "{\"capes\":{\"C\":{\"versions\":{\"1\":{\"url\":\"u\"}}}}}", reader::firmware, 1 },
+        };
+        for (auto const& c : cases) {
+            compare(std::string("inline: ") + c.json, c.json, c.kind, c.rows);
+        }
+    }
+
+    // the fixture folder has cape-inputs.json and strings/ but neither cape-info.json nor defaults/config
+    void test_folder()
+    {
+        cape_config::cape_files const files = cape_config::read_folder(CAPE_TEST_DATA);
+        CHECK(!files.info);
+        CHECK(!files.gpio);
+        CHECK(!files.other);
+        CHECK(files.inputs.has_value());
+        if (files.inputs) {
+            CHECK_EQ(*files.inputs, cape_config::read_inputs(read_file("cape-inputs.json")));
+        }
+        CHECK_EQ(files.strings.size(), 2u);
+        if (files.strings.size() == 2) {
+            CHECK_EQ(files.strings[0].first, "F16-B.json");
+            CHECK_EQ(files.strings[0].second, cape_config::read_string_ports(read_file("strings/F16-B.json")));
+            CHECK_EQ(files.strings[1].first, "serial-first.json");
+        }
+    }
+}
+
+int main()
+{
+    test_fixtures();
+    test_inline();
+    test_folder();
+    return test_result();
+}
@@ -0,0 +1,47 @@
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+// Minimal checks for the unit tests, a failure is reported and the test carries on.
+// main() returns test_result() so ctest sees the outcome.
+namespace test
+{
+	inline int failures{ 0 };
+
+	template<typename A, typename B>
+	void check_eq(A const& actual, B const& expected, char const* expr, char const* file, int line)
+	{
+		if (actual == expected) {
+			return;
+		}
+		std::ostringstream out;
+		out << expr << ": got '" << actual << "', expected '" << expected << "'";
+		std::fprintf(stderr, "%s:%d: %s\n", file, line, out.str().c_str());
+		++failures;
+	}
+
+	inline void check(bool ok, char const* expr, char const* file, int line)
+	{
+		if (!ok) {
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+			++failures;
+		}
+	}
+}
+
+#define CHECK(expr) test::check(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
+#define CHECK_EQ(actual, expected) test::check_eq((actual), (expected), #actual " == " #expected, __FILE__, __LINE__)
+
+inline int test_result()
+{
+	if (test::failures != 0) {
+		std::fprintf(stderr, "%d check(s) failed\n", test::failures);
+		return 1;
+	}
+	return 0;
+}
+
+#endif // TEST_COMMON_H
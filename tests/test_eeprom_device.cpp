@@ -0,0 +1,277 @@
+// eeprom_device against images built here: the probe, the section table, reading and
+// extracting single sections, reopening, and the malformed tables the scanner rejects.
+
+#include "test_common.h"
+
+#include "cape_utils.h"
+#include "eeprom_device.h"
+#include "fpp_layout.h"
+#include "parse_workspace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using image = std::vector<uint8_t>;
+
+    void put_field(image& data, std::string const& text, std::size_t length)
+    {
+        std::string field = text.substr(0, length);
+        field.resize(length, '\0');
+        data.insert(data.end(), field.begin(), field.end());
+    }
+
+    image header(std::string const& name, std::string const& version, std::string const& serial)
+    {
+        image data;
+        put_field(data, std::string(fpp_layout::magic_value), fpp_layout::magic.length);
+        put_field(data, name, fpp_layout::name.length);
+        put_field(data, version, fpp_layout::version.length);
+        put_field(data, serial, fpp_layout::serial.length);
+        return data;
+    }
+
+    void add_section(image& data, int flag, std::string const& path, std::string const& payload, std::size_t length)
+    {
+        char number[16];
+        std::snprintf(number, sizeof(number), "%06zu", length);
+        put_field(data, number, fpp_layout::section_length.length);
+        std::snprintf(number, sizeof(number), "%02d", flag);
+        put_field(data, number, fpp_layout::section_flag.length);
+        if (flag < fpp_layout::path_flag_limit) {
+            put_field(data, path, fpp_layout::section_path.length);
+        }
+        data.insert(data.end(), payload.begin(), payload.end());
+    }
+
+    void add_section(image& data, int flag, std::string const& path, std::string const& payload)
+    {
+        add_section(data, flag, path, payload, payload.size());
+    }
+
+    struct scratch
+    {
+        scratch()
+            : dir(std::filesystem::temp_directory_path() /
+                ("cape_test_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())))
+        {
+            std::filesystem::create_directories(dir);
+        }
+        ~scratch()
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(dir, ec);
+        }
+
+        std::string write(std::string const& name, image const& data) const
+        {
+            std::filesystem::path const path = dir / name;
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            return path.string();
+        }
+
+        std::filesystem::path dir;
+    };
+
+    std::string read_file(std::filesystem::path const& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    image sample()
+    {
+        image data = header("PB16", "2.0", "0000123");
+        add_section(data, 0, "defaults/config/co-other.json", "{\"channelOutputs\":[]}");
+        add_section(data, 96, "", "SERIAL0000000042" + std::string(42, '\0'));
+        add_section(data, 0, "cape-info.json", "{}");
+        return data;
+    }
+
+    void test_probe(scratch const& s)
+    {
+        cape_info const info = cape_utils::probeEEPROM(s.write("probe.bin", sample()));
+        CHECK_EQ(info.name, "PB16");
+        CHECK_EQ(info.version, "2.0");
+        CHECK_EQ(info.serialNumber, "0000123");
+        CHECK(info.error.empty());
+
+        cape_info const missing = cape_utils::probeEEPROM((s.dir / "missing.bin").string());
+        CHECK(missing.name.empty());
+        CHECK(missing.error.starts_with("unable to open"));
+    }
+
+    void test_sections(scratch const& s)
+    {
+        eeprom_device device(s.write("sections.bin", sample()));
+        CHECK(device.open());
+        auto const sections = device.sections();
+        CHECK_EQ(sections.size(), 3u);
+        if (sections.size() != 3) {
+            return;
+        }
+        CHECK_EQ(sections[0].flag, 0);
+        CHECK_EQ(sections[0].offset, fpp_layout::header_size);
+        CHECK_EQ(sections[0].name, "defaults/config/co-other.json");
+        CHECK_EQ(sections[0].payload_offset, fpp_layout::header_size + fpp_layout::section_path.end());
+        CHECK(sections[0].data == nullptr);
+        CHECK_EQ(sections[1].flag, 96);
+        CHECK(sections[1].name.empty());
+        CHECK_EQ(sections[2].name, "cape-info.json");
+        CHECK(device.error().empty());
+
+        auto const payload = device.read_section(sections[0]);
+        CHECK_EQ(std::string(payload.begin(), payload.end()), "{\"channelOutputs\":[]}");
+
+        // a second call is served from the table already read
+        CHECK(device.sections().data() == sections.data());
+    }
+
+    void test_extract(scratch const& s)
+    {
+        eeprom_device device(s.write("extract.bin", sample()));
+        CHECK(device.open());
+        auto const sections = device.sections();
+        if (sections.size() != 3) {
+            CHECK_EQ(sections.size(), 3u);
+            return;
+        }
+        std::string const dir = (s.dir / "extract").string() + "/";
+        std::filesystem::create_directories(dir);
+
+        section_result const file = device.extract(sections[0], dir);
+        CHECK(file.error.empty());
+        CHECK_EQ(read_file(s.dir / "extract" / "defaults" / "config" / "co-other.json"), "{\"channelOutputs\":[]}");
+
+        section_result const serial = device.extract(sections[1], dir);
+        CHECK(serial.serialNumber.has_value());
+        CHECK_EQ(serial.serialNumber.value_or(""), "SERIAL0000000042");
+    }
+
+    void test_reopen(scratch const& s)
+    {
+        image other = header("Other", "1.0", "9");
+        add_section(other, 0, "only.json", "[]");
+
+        std::string const path = s.write("reopen.bin", sample());
+        eeprom_device device(path);
+        CHECK(device.open());
+        CHECK_EQ(device.sections().size(), 3u);
+
+        // the file changes underneath, a second open must start over
+        s.write("reopen.bin", other);
+        CHECK(device.open());
+        CHECK_EQ(device.info().name, "Other");
+        auto const sections = device.sections();
+        CHECK_EQ(sections.size(), 1u);
+        if (sections.size() == 1) {
+            CHECK_EQ(sections[0].name, "only.json");
+        }
+
+        // reopening many times must not run out of file handles
+        bool reopened = true;
+        for (int i = 0; i < 25000 && reopened; ++i) {
+            reopened = device.open();
+        }
+        CHECK(reopened);
+    }
+
+    void test_malformed(scratch const& s)
+    {
+        image bad = sample();
+        bad[0] = 'X';
+        eeprom_device badHeader(s.write("bad_header.bin", bad));
+        CHECK(!badHeader.open());
+        CHECK(badHeader.error().starts_with("missing FPP02 header"));
+        CHECK(badHeader.sections().empty());
+
+        // a length that claims more data than the image holds
+        image truncated = header("Short", "1.0", "1");
+        add_section(truncated, 0, "first.json", "{}");
+        std::size_t const payloadOffset = truncated.size() + fpp_layout::section_path.end();
+        add_section(truncated, 0, "second.json", "abc", 500);
+        eeprom_device device(s.write("past_end.bin", truncated));
+        CHECK(device.open());
+        auto const sections = device.sections();
+        CHECK_EQ(sections.size(), 1u);
+        CHECK_EQ(device.error(), "data runs past end of image at offset " + std::to_string(payloadOffset));
+
+        // the parser reports the same fault through the shared scanner
+        parse_workspace workspace;
+        cape_info const info = cape_utils::parseEEPROM(s.write("past_end_parse.bin", truncated), (s.dir / "past_end").string() + "/", workspace);
+        CHECK_EQ(info.error, device.error());
+
+        image garbage = header("Garbage", "1.0", "1");
+        put_field(garbage, "12x456", fpp_layout::section_length.length);
+        eeprom_device garbled(s.write("garbage.bin", garbage));
+        CHECK(garbled.open());
+        CHECK(garbled.sections().empty());
+        CHECK(!garbled.error().empty());
+    }
+
+    // flags without a handler stay in the table, so an inventory sees them, but are never decoded
+    void test_unhandled(scratch const& s)
+    {
+        image data = header("Vendor", "1.0", "1");
+        add_section(data, 97, "", "reserved");
+        add_section(data, 0, "cape-info.json", "{}");
+        add_section(data, 55, "", "vendor data");
+        add_section(data, 99, "", "xx");
+
+        std::string const path = s.write("unhandled.bin", data);
+        eeprom_device device(path);
+        CHECK(device.open());
+        auto const sections = device.sections();
+        CHECK(device.error().empty());
+        CHECK_EQ(sections.size(), 4u);
+        if (sections.size() == 4) {
+            CHECK_EQ(sections[0].flag, 97);
+            CHECK(sections[0].handler == nullptr);
+            CHECK_EQ(sections[0].size, 8u);
+            CHECK(sections[1].handler != nullptr);
+            CHECK_EQ(sections[2].flag, 55);
+            CHECK(sections[2].handler == nullptr);
+            CHECK_EQ(sections[3].flag, 99);
+            CHECK(sections[3].handler == nullptr);
+
+            section_result const skipped = device.extract(sections[2], (s.dir / "unhandled_device").string() + "/");
+            CHECK(skipped.folder.empty());
+            CHECK(skipped.error.empty());
+        }
+
+        parse_workspace workspace;
+        std::string const dir = (s.dir / "unhandled").string() + "/";
+        cape_info const info = cape_utils::parseEEPROM(path, dir, workspace);
+        CHECK(info.error.empty());
+        CHECK_EQ(workspace.sections().size(), 4u);
+        CHECK_EQ(read_file(std::filesystem::path(dir) / "cape-info.json"), "{}");
+    }
+
+    void test_missing(scratch const& s)
+    {
+        eeprom_device device((s.dir / "missing.bin").string());
+        CHECK(!device.open());
+        CHECK(device.error().starts_with("unable to open"));
+        CHECK(device.sections().empty());
+    }
+}
+
+int main()
+{
+    scratch s;
+    test_probe(s);
+    test_sections(s);
+    test_extract(s);
+    test_reopen(s);
+    test_malformed(s);
+    test_unhandled(s);
+    test_missing(s);
+    return test_result();
+}
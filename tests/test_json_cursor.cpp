@@ -0,0 +1,212 @@
+// json_cursor on its own: walking, skipping, escapes in keys and values, and the malformed
+// and truncated documents that must latch failed() instead of producing values.
+
+#include "test_common.h"
+
+#include "json_cursor.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    // the elements of a top level array of strings, with non-strings read as "?"
+    std::vector<std::string> elements(std::string_view text, bool& failed)
+    {
+        std::vector<std::string> out;
+        json_cursor json(text);
+        if (json.begin_array()) {
+            while (json.next_element()) {
+                out.push_back(json.string().value_or("?"));
+            }
+        }
+        failed = json.failed();
+        return out;
+    }
+
+    // the keys of a top level object, values skipped
+    std::vector<std::string> keys(std::string_view text, bool& failed)
+    {
+        std::vector<std::string> out;
+        json_cursor json(text);
+        if (json.begin_object()) {
+            std::string_view key;
+            while (json.next_member(key)) {
+                out.emplace_back(key);
+                json.skip();
+            }
+        }
+        failed = json.failed();
+        return out;
+    }
+
+    void test_walk()
+    {
+        bool failed{ false };
+        auto const values = elements(R"([ "a", 1, "b", { "x": [ "]" ] }, null, "c" ])", failed);
+        CHECK(!failed);
+        CHECK_EQ(values.size(), 6u);
+        if (values.size() == 6) {
+            CHECK_EQ(values[0], "a");
+            CHECK_EQ(values[1], "?");
+            CHECK_EQ(values[2], "b");
+            CHECK_EQ(values[3], "?");
+            CHECK_EQ(values[5], "c");
+        }
+
+        json_cursor json(R"({ "a": { "b": [ 1, 2 ] }, "c": "d" })");
+        CHECK(json.begin_object());
+        std::string_view key;
+        CHECK(json.next_member(key));
+        CHECK_EQ(key, "a");
+        CHECK(json.skip());
+        CHECK(json.next_member(key));
+        CHECK_EQ(key, "c");
+        CHECK_EQ(json.string().value_or(""), "d");
+        CHECK(!json.next_member(key));
+        CHECK(json.finished());
+    }
+
+    void test_truncated()
+    {
+        char const* const truncated[] = {
+            R"([ "a", "b")",
+            R"([ "a", "b",)",
+            R"([ "a", "b", )",
+            R"([ "a", )",
+            R"([)",
+        };
+        for (char const* text : truncated) {
+            bool failed{ false };
+            auto const values = elements(text, failed);
+            CHECK(failed);
+            // no phantom element for the missing end
+            CHECK(values.size() <= 2);
+            for (auto const& value : values) {
+                CHECK(value == "a" || value == "b");
+            }
+        }
+
+        bool failed{ false };
+        CHECK_EQ(keys(R"({ "a": 1, "b": 2)", failed).size(), 2u);
+        CHECK(failed);
+        CHECK_EQ(keys(R"({ "a": 1,)", failed).size(), 1u);
+        CHECK(failed);
+        CHECK_EQ(keys(R"({ "a": { "b": 1 })", failed).size(), 1u);
+        CHECK(failed);
+
+        json_cursor trailing(R"([ "a" ] x)");
+        CHECK(trailing.begin_array());
+        while (trailing.next_element()) {
+            trailing.skip();
+        }
+        CHECK(!trailing.failed());
+        CHECK(!trailing.finished());
+    }
+
+    void test_malformed()
+    {
+        bool failed{ false };
+        elements(R"([ "a", ])", failed);
+        CHECK(failed);
+        elements(R"([ "\u12G4" ])", failed);
+        CHECK(failed);
+        keys(R"({ "a" 1 })", failed);
+        CHECK(failed);
+        keys(R"({ "\u00" : 1 })", failed);
+        CHECK(failed);
+
+        // commas: missing, leading, doubled
+        CHECK_EQ(elements(R"([ "a" "b" ])", failed).size(), 1u);
+        CHECK(failed);
+        CHECK_EQ(elements(R"([ { "pin": "a" } { "pin": "b" } ])", failed).size(), 1u);
+        CHECK(failed);
+        CHECK(elements(R"([ , "a" ])", failed).empty());
+        CHECK(failed);
+        CHECK_EQ(elements(R"([ "a", , "b" ])", failed).size(), 1u);
+        CHECK(failed);
+        keys(R"({ , "a": 1 })", failed);
+        CHECK(failed);
+        CHECK_EQ(keys(R"({ "a": 1 "b": 2 })", failed).size(), 1u);
+        CHECK(failed);
+
+        // scalars have to be true, false, null or a number
+        char const* const bad_scalars[] = {
+            R"({ "x": garbage })", R"({ "x": tru })", R"({ "x": nul })", R"({ "x": truex })", R"({ "x": - })",
+            R"({ "x": 01 })", R"({ "x": 1. })", R"({ "x": .5 })", R"({ "x": 1e })", R"({ "x": +1 })", R"({ "x": 0x10 })",
+        };
+        for (char const* text : bad_scalars) {
+            keys(text, failed);
+            CHECK(failed);
+        }
+        json_cursor scalars(R"([ true, false, null, 0, -0, 12, -3.25, 1e5, 2E-3, 6.02e+23 ])");
+        CHECK(scalars.begin_array());
+        std::size_t count{ 0 };
+        while (scalars.next_element()) {
+            CHECK(scalars.skip());
+            ++count;
+        }
+        CHECK_EQ(count, 10u);
+        CHECK(scalars.finished());
+    }
+
+    void test_escaped_values()
+    {
+        bool failed{ false };
+        auto const values = elements(R"([ "a\"b", "c\\d", "e\/f", "\n\t", "café", "🎄", "A" ])", failed);
+        CHECK(!failed);
+        CHECK_EQ(values.size(), 7u);
+        if (values.size() == 7) {
+            CHECK_EQ(values[0], "a\"b");
+            CHECK_EQ(values[1], "c\\d");
+            CHECK_EQ(values[2], "e/f");
+            CHECK_EQ(values[3], "\n\t");
+            CHECK_EQ(values[4], "caf\xc3\xa9");
+            CHECK_EQ(values[5], "\xf0\x9f\x8e\x84");
+            CHECK_EQ(values[6], "A");
+        }
+    }
+
+    void test_escaped_keys()
+    {
+        bool failed{ false };
+        auto const names = keys(R"({ "pin": 1, "say \"hi\"": 2, "back\\slash": 3, "plain": 4, "🎄": 5 })", failed);
+        CHECK(!failed);
+        CHECK_EQ(names.size(), 5u);
+        if (names.size() == 5) {
+            CHECK_EQ(names[0], "pin");
+            CHECK_EQ(names[1], "say \"hi\"");
+            CHECK_EQ(names[2], "back\\slash");
+            CHECK_EQ(names[3], "plain");
+            CHECK_EQ(names[4], "\xf0\x9f\x8e\x84");
+        }
+
+        // an escaped key followed by a nested escaped key, the outer value is still read correctly
+        json_cursor json(R"({ "\u006futer": { "in\u006eer": "x" }, "\u0061fter": "y" })");
+        CHECK(json.begin_object());
+        std::string_view key;
+        CHECK(json.next_member(key));
+        CHECK_EQ(key, "outer");
+        CHECK(json.begin_object());
+        CHECK(json.next_member(key));
+        CHECK_EQ(key, "inner");
+        CHECK_EQ(json.string().value_or(""), "x");
+        CHECK(!json.next_member(key));
+        CHECK(json.next_member(key));
+        CHECK_EQ(key, "after");
+        CHECK_EQ(json.string().value_or(""), "y");
+        CHECK(!json.next_member(key));
+        CHECK(json.finished());
+    }
+}
+
+int main()
+{
+    test_walk();
+    test_truncated();
+    test_malformed();
+    test_escaped_values();
+    test_escaped_keys();
+    return test_result();
+}